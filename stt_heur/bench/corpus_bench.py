@@ -0,0 +1,338 @@
+#!/usr/bin/env python3
+"""Benchmark de tempo-ate-o-alvo do stt sobre um diretorio de instancias XHSTT.
+
+uso:
+  corpus_bench.py run --stt ./stt --instances DIR [--seeds 1-5] [--time 60]
+                  [--checkpoints 10,30,60] [--targets alvos.csv]
+                  [--label atual] [--out bench_results] [-- opcoes do stt]
+  corpus_bench.py compare base.csv novo.csv [--metric final|<checkpoint>]
+
+`run` executa o stt em cada instancia (*.xml do diretorio) com cada semente e
+acompanha as melhoras que ele imprime ("*** time: ... fo: H, S"), marcadas
+com o relogio do proprio script (a saida do stt fica em buffer de linha via
+stdbuf, quando disponivel; senao vale o tempo em segundos do log). Grava:
+  <out>/<label>.trace.csv  trajetoria bruta: label,instance,seed,time_s,hard,soft
+  <out>/<label>.csv        uma linha por execucao: tempo ate a primeira solucao
+                           viavel, tempo ate o alvo, custo em cada checkpoint e
+                           custo final
+e imprime a tabela resumo por instancia.
+
+O alvo de cada instancia vem de --targets (CSV instance,soft; hard e sempre 0);
+sem alvo, o tempo ate o alvo fica vazio.
+
+`compare` junta dois <label>.csv (por exemplo, de dois builds) por instancia,
+usa a mediana das sementes e aplica o teste dos postos sinalizados de
+Wilcoxon entre as instancias. O custo e comparado como hard * 10^6 + soft.
+"""
+
+import argparse
+import csv
+import math
+import os
+import re
+import shutil
+import statistics
+import subprocess
+import sys
+import tempfile
+import time
+
+IMPROVED = re.compile(r"^\*\*\* time: *(\d+) +fo: *(\d+), *(\d+)")
+INITIAL = re.compile(r"^Initial solution: *(\d+) *, *(\d+)")
+FINAL_HARD = re.compile(r"^Hard cost: *(\d+)")
+FINAL_SOFT = re.compile(r"^Soft cost: *(\d+)")
+
+HARD_WEIGHT = 10 ** 6
+
+
+# -------------------------------------------------------------------------
+# Execucao
+
+def parse_seeds(text):
+    seeds = []
+    for part in text.split(","):
+        if "-" in part:
+            first, last = part.split("-")
+            seeds.extend(range(int(first), int(last) + 1))
+        else:
+            seeds.append(int(part))
+    return seeds
+
+
+def read_targets(fname):
+    targets = {}
+    if fname:
+        with open(fname) as f:
+            for row in csv.DictReader(f):
+                targets[row["instance"]] = int(row["soft"])
+    return targets
+
+
+def run_once(args, xml, seed, workdir):
+    """Executa o stt e devolve a trajetoria [(t, hard, soft)] e o custo final."""
+    out = os.path.join(workdir, "soln.xml")
+    cmd = [args.stt, xml, out, str(args.time), str(seed)] + args.options
+    if shutil.which("stdbuf"):
+        cmd = ["stdbuf", "-oL"] + cmd
+    start = time.monotonic()
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL,
+                            universal_newlines=True, bufsize=1)
+    trace, final_hard, final_soft = [], None, None
+    line_buffered = cmd[0] == "stdbuf"
+    for line in proc.stdout:
+        now = time.monotonic() - start
+        m = INITIAL.match(line)
+        if m:
+            trace.append((now, int(m.group(1)), int(m.group(2))))
+            continue
+        m = IMPROVED.match(line)
+        if m:
+            t = now if line_buffered else float(m.group(1))
+            trace.append((t, int(m.group(2)), int(m.group(3))))
+            continue
+        m = FINAL_HARD.match(line)
+        if m:
+            final_hard = int(m.group(1))
+            continue
+        m = FINAL_SOFT.match(line)
+        if m:
+            final_soft = int(m.group(1))
+    proc.wait()
+    if proc.returncode != 0 or final_hard is None or final_soft is None:
+        return trace, None
+    return trace, (final_hard, final_soft, time.monotonic() - start)
+
+
+def best_at(trace, t):
+    best = None
+    for (when, hard, soft) in trace:
+        if when > t:
+            break
+        if best is None or (hard, soft) < best:
+            best = (hard, soft)
+    return best
+
+
+def first_time(trace, accept):
+    for (when, hard, soft) in trace:
+        if accept(hard, soft):
+            return when
+    return None
+
+
+def fmt(value, digits=1):
+    if value is None:
+        return ""
+    if isinstance(value, float):
+        return "%.*f" % (digits, value)
+    return str(value)
+
+
+def cost_text(cost):
+    return "" if cost is None else "%d/%d" % cost
+
+
+def run(args):
+    instances = sorted(f for f in os.listdir(args.instances) if f.endswith(".xml"))
+    if not instances:
+        sys.exit("no *.xml in %s" % args.instances)
+    seeds = parse_seeds(args.seeds)
+    checkpoints = [float(c) for c in args.checkpoints.split(",")] if args.checkpoints else []
+    targets = read_targets(args.targets)
+    os.makedirs(args.out, exist_ok=True)
+
+    fields = ["label", "instance", "seed", "first_feasible_s", "target", "target_s"]
+    fields += ["cost_at_%gs" % c for c in checkpoints]
+    fields += ["final_hard", "final_soft", "wall_s"]
+    rows = []
+    with open(os.path.join(args.out, args.label + ".trace.csv"), "w", newline="") as ftrace, \
+            tempfile.TemporaryDirectory() as workdir:
+        traces = csv.writer(ftrace)
+        traces.writerow(["label", "instance", "seed", "time_s", "hard", "soft"])
+        for xml in instances:
+            name = os.path.splitext(xml)[0]
+            target = targets.get(name)
+            for seed in seeds:
+                trace, final = run_once(args, os.path.join(args.instances, xml), seed, workdir)
+                for (when, hard, soft) in trace:
+                    traces.writerow([args.label, name, seed, "%.3f" % when, hard, soft])
+                row = {"label": args.label, "instance": name, "seed": seed,
+                       "target": fmt(target)}
+                row["first_feasible_s"] = fmt(first_time(trace, lambda h, s: h == 0), 3)
+                if target is not None:
+                    row["target_s"] = fmt(first_time(trace, lambda h, s: h == 0 and s <= target), 3)
+                for c in checkpoints:
+                    row["cost_at_%gs" % c] = cost_text(best_at(trace, c))
+                if final is not None:
+                    row["final_hard"], row["final_soft"] = final[0], final[1]
+                    row["wall_s"] = fmt(final[2], 3)
+                rows.append(row)
+                print("%s seed %d: %s" % (name, seed,
+                      "failed" if final is None else "%d/%d" % final[:2]), file=sys.stderr)
+
+    summary = os.path.join(args.out, args.label + ".csv")
+    with open(summary, "w", newline="") as f:
+        writer = csv.DictWriter(f, fieldnames=fields)
+        writer.writeheader()
+        writer.writerows(rows)
+    print_table(rows, checkpoints)
+    print("\nwritten %s and %s.trace.csv" % (summary, os.path.join(args.out, args.label)))
+
+
+def median_or_none(values):
+    values = [v for v in values if v is not None]
+    return statistics.median(values) if values else None
+
+
+def parse_cost(text):
+    if not text:
+        return None
+    hard, soft = text.split("/")
+    return int(hard), int(soft)
+
+
+def print_table(rows, checkpoints):
+    header = ["instance", "runs", "feasible", "t_feasible", "hit", "t_target"]
+    header += ["@%gs" % c for c in checkpoints] + ["final"]
+    lines = [header]
+    for name in sorted(set(r["instance"] for r in rows)):
+        runs = [r for r in rows if r["instance"] == name]
+        feasible = [float(r["first_feasible_s"]) for r in runs if r["first_feasible_s"]]
+        hits = [float(r["target_s"]) for r in runs if r.get("target_s")]
+        line = [name, str(len(runs)), "%d/%d" % (len(feasible), len(runs)),
+                fmt(median_or_none(feasible), 2)]
+        line += ["%d/%d" % (len(hits), len(runs)) if runs[0]["target"] else "",
+                 fmt(median_or_none(hits), 2)]
+        for c in checkpoints:
+            costs = [parse_cost(r["cost_at_%gs" % c]) for r in runs]
+            line.append(cost_text(median_cost(costs)))
+        finals = [(r["final_hard"], r["final_soft"]) for r in runs if r.get("final_hard") is not None]
+        line.append(cost_text(median_cost([(int(h), int(s)) for (h, s) in finals])))
+        lines.append(line)
+    widths = [max(len(l[i]) for l in lines) for i in range(len(header))]
+    for l in lines:
+        print("  ".join(v.ljust(w) for v, w in zip(l, widths)))
+
+
+def median_cost(costs):
+    """Mediana (inferior) dos custos, ordenados lexicograficamente."""
+    costs = sorted(c for c in costs if c is not None)
+    return costs[(len(costs) - 1) // 2] if costs else None
+
+
+# -------------------------------------------------------------------------
+# Comparacao
+
+def wilcoxon(differences):
+    """Teste dos postos sinalizados de Wilcoxon (bilateral), descartando os
+    empates em zero e usando postos medios. Devolve (W+, n, p): exato por
+    enumeracao ate 25 pares sem empates, aproximacao normal acima disso."""
+    d = [x for x in differences if x != 0]
+    n = len(d)
+    if n == 0:
+        return 0.0, 0, 1.0
+    order = sorted(range(n), key=lambda i: abs(d[i]))
+    ranks = [0.0] * n
+    i = 0
+    while i < n:
+        j = i
+        while j + 1 < n and abs(d[order[j + 1]]) == abs(d[order[i]]):
+            j += 1
+        for k in range(i, j + 1):
+            ranks[order[k]] = (i + j) / 2.0 + 1
+        i = j + 1
+    w_plus = sum(r for r, x in zip(ranks, d) if x > 0)
+    ties = len(set(abs(x) for x in d)) < n
+
+    if n <= 25 and not ties:
+        # distribuicao exata de W+: contagem dos subconjuntos de {1..n}
+        total = n * (n + 1) // 2
+        counts = [1] + [0] * total
+        for r in range(1, n + 1):
+            for s in range(total, r - 1, -1):
+                counts[s] += counts[s - r]
+        w = int(round(min(w_plus, total - w_plus)))
+        p = 2.0 * sum(counts[:w + 1]) / 2 ** n
+        return w_plus, n, min(1.0, p)
+
+    mean = n * (n + 1) / 4.0
+    tie_groups = {}
+    for x in d:
+        tie_groups[abs(x)] = tie_groups.get(abs(x), 0) + 1
+    var = n * (n + 1) * (2 * n + 1) / 24.0
+    var -= sum(t ** 3 - t for t in tie_groups.values()) / 48.0
+    if var <= 0:
+        return w_plus, n, 1.0
+    z = (abs(w_plus - mean) - 0.5) / math.sqrt(var)
+    p = math.erfc(max(z, 0.0) / math.sqrt(2))
+    return w_plus, n, min(1.0, p)
+
+
+def load_costs(fname, metric):
+    """Mediana (inferior) por instancia do custo escalar hard * 10^6 + soft."""
+    costs = {}
+    with open(fname) as f:
+        for row in csv.DictReader(f):
+            if metric == "final":
+                if row["final_hard"] == "":
+                    continue
+                cost = (int(row["final_hard"]), int(row["final_soft"]))
+            else:
+                cost = parse_cost(row.get("cost_at_%ss" % metric, ""))
+                if cost is None:
+                    continue
+            costs.setdefault(row["instance"], []).append(cost[0] * HARD_WEIGHT + cost[1])
+    return {name: statistics.median_low(values) for name, values in costs.items()}
+
+
+def compare(args):
+    base = load_costs(args.base, args.metric)
+    new = load_costs(args.new, args.metric)
+    common = sorted(set(base) & set(new))
+    if not common:
+        sys.exit("no instances in common")
+    print("%-30s %14s %14s %14s" % ("instance", "base", "new", "new - base"))
+    differences = []
+    for name in common:
+        diff = new[name] - base[name]
+        differences.append(diff)
+        print("%-30s %14g %14g %14g" % (name, base[name], new[name], diff))
+    better = sum(1 for x in differences if x < 0)
+    worse = sum(1 for x in differences if x > 0)
+    w_plus, n, p = wilcoxon(differences)
+    print("\nmetric %s: new better on %d, worse on %d, tied on %d of %d instances"
+          % (args.metric, better, worse, len(common) - better - worse, len(common)))
+    print("Wilcoxon signed-rank: W+ = %g, n = %d, p = %.4g (two-sided)" % (w_plus, n, p))
+
+
+# -------------------------------------------------------------------------
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command")
+    p = sub.add_parser("run")
+    p.add_argument("--stt", default="./stt")
+    p.add_argument("--instances", required=True)
+    p.add_argument("--seeds", default="1-5")
+    p.add_argument("--time", type=int, default=60)
+    p.add_argument("--checkpoints", default="10,30,60")
+    p.add_argument("--targets")
+    p.add_argument("--label", default="current")
+    p.add_argument("--out", default="bench_results")
+    p.add_argument("options", nargs="*")
+    c = sub.add_parser("compare")
+    c.add_argument("base")
+    c.add_argument("new")
+    c.add_argument("--metric", default="final")
+    args = parser.parse_args()
+    if args.command == "run":
+        run(args)
+    elif args.command == "compare":
+        compare(args)
+    else:
+        parser.print_help()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,314 @@
+#!/usr/bin/env python3
+"""Ajuste de parametros do stt por corrida (F-race) sobre instancias de treino.
+
+uso:
+  race_tuner.py --stt ./stt --instances DIR [--params tuner_params.txt]
+                [--seeds 1-10] [--time 30] [--candidates 16] [--parallel N]
+                [--first-test 5] [--alpha 0.05] [--budget 0] [--rng 1]
+                [--out best.cfg] [--log race.csv] [-- opcoes fixas do stt]
+
+Os candidatos sao a configuracao padrao (sem opcoes) e configuracoes
+sorteadas no espaco do arquivo de parametros. Cada bloco da corrida e um par
+(instancia, semente) do conjunto de treino, em ordem embaralhada; todos os
+candidatos vivos rodam no bloco, ate --parallel processos locais ao mesmo
+tempo (o tempo limite e de parede: use no maximo um processo por nucleo).
+
+A partir do bloco --first-test, o teste de Friedman sobre os postos dos
+custos em cada bloco decide se ha diferenca; havendo, os candidatos cuja
+soma de postos supera a do melhor alem da diferenca critica do teste de
+Conover (o pos-teste do F-race) sao eliminados. Com dois candidatos, o teste
+e o de Wilcoxon pareado. A corrida termina quando os blocos acabam, quando
+resta um candidato ou quando --budget execucoes foram feitas.
+
+O melhor candidato (menor posto medio entre os vivos) vai para --out, uma
+opcao -chave=valor por linha, que o stt le com -config=best.cfg; cada
+execucao vai para --log.
+
+Arquivo de parametros: uma linha por parametro, com o nome da opcao (sem o
+'-'), o tipo (i inteiro, r real, c categorico) e o intervalo (min max, com
+'log' para sortear na escala logaritmica) ou os valores; '#' comenta.
+"""
+
+import argparse
+import concurrent.futures
+import csv
+import math
+import os
+import random
+import shutil
+import sys
+import tempfile
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import corpus_bench
+
+HARD_WEIGHT = corpus_bench.HARD_WEIGHT
+
+
+# -------------------------------------------------------------------------
+# Espaco de parametros
+
+class Parameter:
+    def __init__(self, line):
+        words = line.split()
+        self.name, self.kind = words[0], words[1]
+        if self.kind == "c":
+            self.values = words[2:]
+        elif self.kind in ("i", "r"):
+            self.low, self.high = float(words[2]), float(words[3])
+            self.log = len(words) > 4 and words[4] == "log"
+        else:
+            raise ValueError("unknown parameter type %s" % self.kind)
+
+    def sample(self, rng):
+        if self.kind == "c":
+            return rng.choice(self.values)
+        if self.log:
+            value = math.exp(rng.uniform(math.log(self.low), math.log(self.high)))
+        else:
+            value = rng.uniform(self.low, self.high)
+        if self.kind == "i":
+            return str(int(round(value)))
+        return "%.4g" % value
+
+
+def read_parameters(fname):
+    parameters = []
+    with open(fname) as f:
+        for line in f:
+            line = line.split("#")[0].strip()
+            if line:
+                parameters.append(Parameter(line))
+    return parameters
+
+
+# -------------------------------------------------------------------------
+# Estatistica (Friedman, Conover e as distribuicoes que eles usam)
+
+def gammaincc(a, x):
+    """Funcao gama incompleta superior regularizada Q(a, x)."""
+    if x <= 0:
+        return 1.0
+    lngamma = math.lgamma(a)
+    if x < a + 1:
+        term = total = 1.0 / a
+        n = a
+        for _ in range(1000):
+            n += 1
+            term *= x / n
+            total += term
+            if abs(term) < abs(total) * 1e-15:
+                break
+        return max(0.0, 1.0 - total * math.exp(-x + a * math.log(x) - lngamma))
+    b = x + 1 - a
+    c = 1.0 / 1e-300
+    d = 1.0 / b
+    h = d
+    for i in range(1, 1000):
+        an = -i * (i - a)
+        b += 2
+        d = an * d + b
+        d = 1e-300 if abs(d) < 1e-300 else d
+        c = b + an / c
+        c = 1e-300 if abs(c) < 1e-300 else c
+        d = 1.0 / d
+        h *= d * c
+        if abs(d * c - 1) < 1e-15:
+            break
+    return math.exp(-x + a * math.log(x) - lngamma) * h
+
+
+def chi2_sf(x, df):
+    return gammaincc(df / 2.0, x / 2.0)
+
+
+def betainc(a, b, x):
+    """Funcao beta incompleta regularizada I_x(a, b)."""
+    if x <= 0:
+        return 0.0
+    if x >= 1:
+        return 1.0
+    front = math.exp(math.lgamma(a + b) - math.lgamma(a) - math.lgamma(b)
+                     + a * math.log(x) + b * math.log(1 - x))
+    if x > (a + 1) / (a + b + 2):
+        return 1.0 - betainc(b, a, 1 - x)
+    # fracao continuada de Lentz
+    c, d = 1.0, 1.0 - (a + b) * x / (a + 1)
+    d = 1.0 / (1e-300 if abs(d) < 1e-300 else d)
+    h = d
+    for m in range(1, 1000):
+        for numerator in (m * (b - m) * x / ((a + 2 * m - 1) * (a + 2 * m)),
+                          -(a + m) * (a + b + m) * x / ((a + 2 * m) * (a + 2 * m + 1))):
+            d = 1.0 + numerator * d
+            d = 1.0 / (1e-300 if abs(d) < 1e-300 else d)
+            c = 1.0 + numerator / c
+            c = 1e-300 if abs(c) < 1e-300 else c
+            h *= d * c
+        if abs(d * c - 1) < 1e-15:
+            break
+    return front * h / a
+
+
+def t_ppf(p, df):
+    """Quantil p (> 0.5) da distribuicao t de Student, por bissecao."""
+    def cdf(t):
+        return 1.0 - 0.5 * betainc(df / 2.0, 0.5, df / (df + t * t))
+    low, high = 0.0, 1000.0
+    for _ in range(200):
+        mid = (low + high) / 2
+        if cdf(mid) < p:
+            low = mid
+        else:
+            high = mid
+    return (low + high) / 2
+
+
+def block_ranks(costs):
+    """Postos (medios nos empates) dos custos de um bloco."""
+    order = sorted(range(len(costs)), key=lambda i: costs[i])
+    ranks = [0.0] * len(costs)
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and costs[order[j + 1]] == costs[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            ranks[order[k]] = (i + j) / 2.0 + 1
+        i = j + 1
+    return ranks
+
+
+def failed_as_worst(row):
+    """Custos de um bloco com as execucoes que falharam (math.inf) trocadas
+    por um valor finito pior que todos os outros, empatadas entre si: um
+    inf - inf daria NaN nas diferencas do Wilcoxon."""
+    finite = [x for x in row if x != math.inf]
+    worst = (max(finite) if finite else 0) + HARD_WEIGHT
+    return [worst if x == math.inf else x for x in row]
+
+
+def race_step(results, alive, alpha):
+    """Candidatos eliminados apos os blocos ja avaliados (F-race)."""
+    blocks = [failed_as_worst([results[b][c] for c in alive]) for b in range(len(results))]
+    b, k = len(blocks), len(alive)
+    if k == 2:
+        differences = [row[1] - row[0] for row in blocks]
+        w_plus, n, p = corpus_bench.wilcoxon(differences)
+        if p >= alpha:
+            return []
+        return [alive[1]] if sum(differences) > 0 else [alive[0]]
+
+    ranks = [block_ranks(row) for row in blocks]
+    sums = [sum(r[j] for r in ranks) for j in range(k)]
+    a = sum(x * x for r in ranks for x in r)
+    c = b * k * (k + 1) ** 2 / 4.0
+    if a - c <= 0:
+        return []
+    statistic = (k - 1) * sum((s - b * (k + 1) / 2.0) ** 2 for s in sums) / (a - c)
+    if chi2_sf(statistic, k - 1) >= alpha:
+        return []
+
+    # pos-teste de Conover contra o melhor
+    df = (b - 1) * (k - 1)
+    spread = 2 * b * (a - sum(s * s for s in sums) / b) / df
+    critical = t_ppf(1 - alpha / 2, df) * math.sqrt(max(spread, 0.0))
+    best = min(sums)
+    return [alive[j] for j in range(k) if sums[j] - best > critical]
+
+
+# -------------------------------------------------------------------------
+# Corrida
+
+def evaluate(args, options, xml, seed):
+    workdir = tempfile.mkdtemp(prefix="race")
+    try:
+        run = argparse.Namespace(stt=args.stt, time=args.time, options=options)
+        trace, final = corpus_bench.run_once(run, xml, seed, workdir)
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+    return final
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    here = os.path.dirname(os.path.abspath(__file__))
+    parser.add_argument("--stt", default="./stt")
+    parser.add_argument("--instances", required=True)
+    parser.add_argument("--params", default=os.path.join(here, "tuner_params.txt"))
+    parser.add_argument("--seeds", default="1-10")
+    parser.add_argument("--time", type=int, default=30)
+    parser.add_argument("--candidates", type=int, default=16)
+    parser.add_argument("--parallel", type=int, default=os.cpu_count() or 1)
+    parser.add_argument("--first-test", type=int, default=5)
+    parser.add_argument("--alpha", type=float, default=0.05)
+    parser.add_argument("--budget", type=int, default=0)
+    parser.add_argument("--rng", type=int, default=1)
+    parser.add_argument("--out", default="best.cfg")
+    parser.add_argument("--log", default="race.csv")
+    parser.add_argument("options", nargs="*")
+    args = parser.parse_args()
+
+    rng = random.Random(args.rng)
+    parameters = read_parameters(args.params)
+    candidates = [[]]
+    while len(candidates) < args.candidates:
+        candidates.append(["-%s=%s" % (p.name, p.sample(rng)) for p in parameters])
+
+    instances = sorted(f for f in os.listdir(args.instances) if f.endswith(".xml"))
+    if not instances:
+        sys.exit("no *.xml in %s" % args.instances)
+    blocks = [(xml, seed) for xml in instances for seed in corpus_bench.parse_seeds(args.seeds)]
+    rng.shuffle(blocks)
+
+    alive = list(range(len(candidates)))
+    results = []    # custo de cada candidato em cada bloco ja avaliado
+    runs = 0
+    with open(args.log, "w", newline="") as flog, \
+            concurrent.futures.ThreadPoolExecutor(max_workers=max(1, args.parallel)) as pool:
+        log = csv.writer(flog)
+        log.writerow(["block", "instance", "seed", "candidate", "hard", "soft", "options"])
+        for (xml, seed) in blocks:
+            if len(alive) == 1 or (args.budget and runs + len(alive) > args.budget):
+                break
+            futures = {c: pool.submit(evaluate, args, candidates[c] + args.options,
+                                      os.path.join(args.instances, xml), seed) for c in alive}
+            costs = {}
+            for c in alive:
+                final = futures[c].result()
+                costs[c] = math.inf if final is None else final[0] * HARD_WEIGHT + final[1]
+                log.writerow([len(results) + 1, xml, seed, c,
+                              "" if final is None else final[0],
+                              "" if final is None else final[1], " ".join(candidates[c])])
+            flog.flush()
+            runs += len(alive)
+            results.append(costs)
+
+            eliminated = []
+            if len(results) >= args.first_test:
+                eliminated = race_step(results, alive, args.alpha)
+                alive = [c for c in alive if c not in eliminated]
+            print("block %d (%s, seed %d): %d alive%s" % (
+                len(results), xml, seed, len(alive),
+                "" if not eliminated else ", eliminated %s" % eliminated), file=sys.stderr)
+
+    if not results:
+        sys.exit("no block evaluated (budget too small?)")
+    ranks = [block_ranks(failed_as_worst([row[c] for c in alive])) for row in results]
+    mean_ranks = [sum(r[j] for r in ranks) / len(ranks) for j in range(len(alive))]
+    best = alive[min(range(len(alive)), key=lambda j: mean_ranks[j])]
+
+    with open(args.out, "w") as f:
+        f.write("# race_tuner: candidate %d of %d, best mean rank among %d survivors\n"
+                % (best, len(candidates), len(alive)))
+        f.write("# after %d blocks (%d runs of %ds) over %s\n"
+                % (len(results), runs, args.time, args.instances))
+        for option in candidates[best]:
+            f.write(option + "\n")
+    for j, c in enumerate(alive):
+        print("candidate %d: mean rank %.2f  %s" % (c, mean_ranks[j], " ".join(candidates[c]) or "(defaults)"))
+    print("best configuration (candidate %d) written to %s" % (best, args.out))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,95 @@
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <vector>
+
+extern "C" {
+#include "../stt_heur/khe/khe.h"
+};
+
+using namespace std;
+
+// Benchmark de atribuicao/desatribuicao de horarios em solucoes com muitos
+// conflitos: os meets sao concentrados em poucos horarios e entao movidos
+// entre eles, com desfazer, como fazem as heuristicas.
+//
+// uso: stt_bench_timetable <instance.xml> [moves] [clash_times] [seed]
+
+//--------------------------------------------------------------------------
+
+static KHE_ARCHIVE ReadArchive(const char *fname) {
+    FILE *fp;  KHE_ARCHIVE res;  KML_ERROR ke;
+    fp = fopen(fname, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "khe: cannot open file \"%s\" for reading\n", fname);
+        exit( EXIT_FAILURE );
+    }
+    if (!KheArchiveRead(fp, &res, true, &ke)) {
+        fprintf(stderr, "%s:%d:%d: %s\n", fname, KmlErrorLineNum(ke), KmlErrorColNum(ke), KmlErrorString(ke));
+        exit( EXIT_FAILURE );
+    }
+    return res;
+}
+
+// media de meets por celula ocupada nos timetables dos recursos
+static double meanClashDepth(KHE_SOLN soln, KHE_INSTANCE instance) {
+    long meets = 0, cells = 0;
+    for (int r = 0; r < KheInstanceResourceCount(instance); r++) {
+        KHE_TIMETABLE_MONITOR tm = KheResourceTimetableMonitor(soln, KheInstanceResource(instance, r));
+        for (int t = 0; t < KheInstanceTimeCount(instance); t++) {
+            int count = KheTimetableMonitorTimeMeetCount(tm, KheInstanceTime(instance, t));
+            if (count > 0) {
+                meets += count;
+                cells++;
+            }
+        }
+    }
+    return cells > 0 ? (double) meets / cells : 0.0;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <instance.xml> [moves] [clash_times] [seed]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    int moves = argc > 2 ? atoi(argv[2]) : 1000000;
+    int clashTimes = argc > 3 ? atoi(argv[3]) : 2;
+    srand(argc > 4 ? atoi(argv[4]) : 1);
+
+    KHE_ARCHIVE archive = ReadArchive(argv[1]);
+    KHE_INSTANCE instance = KheArchiveInstance(archive, 0);
+    KHE_SOLN soln = KheSolnGroupSoln(KheArchiveSolnGroup(archive, 0), 0);
+    printf("instance: %s\n", KheInstanceName(instance));
+    printf("mean clash depth (initial): %.2lf\n", meanClashDepth(soln, instance));
+
+    // concentra os meets moveis nos primeiros clash_times horarios
+    vector< int > movable;
+    for (int i = 0; i < KheSolnMeetCount(soln); i++) {
+        KHE_MEET meet = KheSolnMeet(soln, i);
+        if (KheMeetIsCycleMeet(meet) || KheMeetAsstTime(meet) == NULL) continue;
+        if (KheMeetMoveTime(meet, KheInstanceTime(instance, movable.size() % clashTimes)))
+            movable.push_back(i);
+    }
+    printf("movable meets: %d in %d times\n", (int) movable.size(), clashTimes);
+    printf("mean clash depth (clash-heavy): %.2lf\n", meanClashDepth(soln, instance));
+    if (movable.empty()) return 0;
+
+    clock_t start = clock();
+    int done = 0;
+    for (int i = 0; i < moves; i++) {
+        KHE_MEET meet = KheSolnMeet(soln, movable[rand() % movable.size()]);
+        KHE_TIME time = KheInstanceTime(instance, rand() % clashTimes);
+
+        KHE_TRANSACTION t = KheTransactionMake(soln);
+        KheTransactionBegin(t);
+        if (KheMeetMoveTime(meet, time)) done++;
+        KheTransactionEnd(t);
+        KheSolnCost(soln);
+        if (i % 2 == 0) KheTransactionUndo(t);
+        KheTransactionDelete(t);
+    }
+    double secs = (double) (clock() - start) / CLOCKS_PER_SEC;
+
+    printf("moves: %d (%d changed)  time: %.3lfs  moves/s: %.0lf\n", moves, done, secs, moves / secs);
+    return 0;
+}
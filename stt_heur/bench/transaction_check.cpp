@@ -0,0 +1,220 @@
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <vector>
+
+extern "C" {
+#include "../stt_heur/khe/khe.h"
+};
+
+using namespace std;
+
+// Teste de desfazer transacoes com varias divisoes e juncoes de meets: cada
+// transacao e desfeita e a solucao precisa voltar exatamente ao que era
+// (mesmos meets e tasks nos mesmos indices, mesmas atribuicoes, hash e custo).
+// Os logs das transacoes tambem sao reproduzidos numa copia da solucao, que
+// precisa terminar com o mesmo hash de atribuicoes e o mesmo custo.
+//
+// uso: stt_check_transaction <instance.xml> [transactions] [ops] [seed]
+
+//--------------------------------------------------------------------------
+
+static KHE_ARCHIVE ReadArchive(const char *fname) {
+    FILE *fp;  KHE_ARCHIVE res;  KML_ERROR ke;
+    fp = fopen(fname, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "khe: cannot open file \"%s\" for reading\n", fname);
+        exit( EXIT_FAILURE );
+    }
+    if (!KheArchiveRead(fp, &res, true, &ke)) {
+        fprintf(stderr, "%s:%d:%d: %s\n", fname, KmlErrorLineNum(ke), KmlErrorColNum(ke), KmlErrorString(ke));
+        exit( EXIT_FAILURE );
+    }
+    return res;
+}
+
+// estado de um meet ou task que o desfazer precisa restaurar
+struct Snapshot {
+    vector< KHE_EVENT > events;
+    vector< int > durations, targets, offsets;
+    vector< int > taskMeets, taskTargets;
+    uint64_t hash;
+    KHE_COST cost;
+
+    Snapshot(KHE_SOLN soln) {
+        for (int i = 0; i < KheSolnMeetCount(soln); i++) {
+            KHE_MEET meet = KheSolnMeet(soln, i);
+            events.push_back(KheMeetEvent(meet));
+            durations.push_back(KheMeetDuration(meet));
+            targets.push_back(KheMeetAsst(meet) == NULL ? -1 : KheMeetIndex(KheMeetAsst(meet)));
+            offsets.push_back(KheMeetAsstOffset(meet));
+        }
+        for (int i = 0; i < KheSolnTaskCount(soln); i++) {
+            KHE_TASK task = KheSolnTask(soln, i);
+            taskMeets.push_back(KheTaskMeet(task) == NULL ? -1 : KheMeetIndex(KheTaskMeet(task)));
+            taskTargets.push_back(KheTaskAsst(task) == NULL ? -1 : KheTaskIndexInSoln(KheTaskAsst(task)));
+        }
+        hash = KheSolnAssignHash(soln);
+        cost = KheSolnCost(soln);
+    }
+
+    // compara com a solucao; so indices sao comparados, pois o desfazer de
+    // uma juncao recria meets e tasks em outros enderecos
+    bool matches(KHE_SOLN soln, const char *label) const {
+        Snapshot now(soln);
+        if (now.events.size() != events.size() || now.taskMeets.size() != taskMeets.size()) {
+            printf("%s: %d meets and %d tasks, expected %d and %d\n", label, (int) now.events.size(),
+                    (int) now.taskMeets.size(), (int) events.size(), (int) taskMeets.size());
+            return false;
+        }
+        for (int i = 0; i < (int) events.size(); i++)
+            if (now.events[i] != events[i] || now.durations[i] != durations[i] ||
+                    now.targets[i] != targets[i] || now.offsets[i] != offsets[i]) {
+                printf("%s: meet %d differs\n", label, i);
+                return false;
+            }
+        if (now.taskMeets != taskMeets || now.taskTargets != taskTargets) {
+            printf("%s: tasks differ\n", label);
+            return false;
+        }
+        if (now.hash != hash) {
+            printf("%s: assignment hash differs\n", label);
+            return false;
+        }
+        if (now.cost != cost) {
+            printf("%s: cost %.5lf, expected %.5lf\n", label, KheCostShow(now.cost), KheCostShow(cost));
+            return false;
+        }
+        return true;
+    }
+};
+
+// divide Y em Y1 e Y2 e X em X1 e X2 (X2 fica no ultimo indice), junta Y1
+// e Y2 (X2 vai para o indice de Y2), junta X1 e X2 e desfaz tudo
+static bool splitMergeMerge(KHE_SOLN soln) {
+    KHE_MEET x = NULL, y = NULL, x1, x2, y1, y2, merged;
+    for (int i = 0; i < KheSolnMeetCount(soln) && x == NULL; i++) {
+        KHE_MEET meet = KheSolnMeet(soln, i);
+        if (KheMeetDuration(meet) >= 2 && KheMeetSplitCheck(meet, 1, false)) {
+            if (y == NULL) y = meet;
+            else x = meet;
+        }
+    }
+    if (x == NULL) {
+        printf("split/merge/merge: fewer than two splittable meets\n");
+        return false;
+    }
+
+    Snapshot before(soln);
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    KheTransactionBegin(t);
+    KheMeetSplit(y, 1, false, &y1, &y2);
+    KheMeetSplit(x, 1, false, &x1, &x2);
+    if (!KheMeetMerge(y1, y2, &merged) || KheMeetIndex(x2) != KheSolnMeetCount(soln) - 1 ||
+            !KheMeetMerge(x1, x2, &merged)) {
+        printf("split/merge/merge: cannot merge the split meets back\n");
+        return false;
+    }
+    KheTransactionEnd(t);
+    KheTransactionUndo(t);
+    KheTransactionDelete(t);
+    return before.matches(soln, "split/merge/merge");
+}
+
+// uma operacao sorteada: divisao, juncao ou troca de horario; metade das
+// vezes sobre os ultimos meets, onde ficam os criados por divisoes recentes
+static void randomOp(KHE_SOLN soln, KHE_INSTANCE instance) {
+    int count = KheSolnMeetCount(soln);
+    int index = rand() % 2 == 0 ? rand() % count : count - 1 - rand() % min(count, 4);
+    KHE_MEET meet = KheSolnMeet(soln, index), meet1, meet2;
+    if (KheMeetIsCycleMeet(meet) || KheMeetEvent(meet) == NULL) return;
+    switch (rand() % 3) {
+        case 0:
+            if (KheMeetDuration(meet) >= 2)
+                KheMeetSplit(meet, 1 + rand() % (KheMeetDuration(meet) - 1), false, &meet1, &meet2);
+            break;
+        case 1:
+            for (int i = 0; i < KheEventMeetCount(soln, KheMeetEvent(meet)); i++) {
+                meet2 = KheEventMeet(soln, KheMeetEvent(meet), i);
+                if (KheMeetMerge(meet, meet2, &meet1)) break;
+            }
+            break;
+        default:
+            if (KheMeetAsstTime(meet) != NULL)
+                KheMeetMoveTime(meet, KheInstanceTime(instance, rand() % KheInstanceTimeCount(instance)));
+            break;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <instance.xml> [transactions] [ops] [seed]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    int transactions = argc > 2 ? atoi(argv[2]) : 2000;
+    int ops = argc > 3 ? atoi(argv[3]) : 32;
+    srand(argc > 4 ? atoi(argv[4]) : 1);
+
+    KHE_ARCHIVE archive = ReadArchive(argv[1]);
+    KHE_INSTANCE instance = KheArchiveInstance(archive, 0);
+    KHE_SOLN soln = KheSolnGroupSoln(KheArchiveSolnGroup(archive, 0), 0);
+
+    if (!splitMergeMerge(soln)) return EXIT_FAILURE;
+    printf("split/merge/merge: OK\n");
+
+    // transacoes sorteadas; metade e desfeita e conferida, a outra metade
+    // fica, para que as seguintes partam de solucoes diferentes. Os logs sao
+    // reproduzidos numa copia, que precisa acompanhar a solucao: o da
+    // transacao externa, que inclui o desfazer, quando e portavel (desfazer
+    // uma juncao pode restaurar um dominio, o que nao e); senao o da propria
+    // transacao, quando ela fica
+    KHE_SOLN copy = KheSolnCopy(soln);
+    vector< int > log;
+    int splits = 0, merges = 0, replayed = 0, replayedUndos = 0;
+    for (int i = 0; i < transactions; i++) {
+        Snapshot before(soln);
+        int meets = KheSolnMeetCount(soln);
+        bool undone = false;
+        KHE_TRANSACTION outer = KheTransactionMake(soln);
+        KheTransactionSetLogging(outer, true);
+        KheTransactionBegin(outer);
+        KHE_TRANSACTION t = KheTransactionMake(soln);
+        KheTransactionSetLogging(t, true);
+        KheTransactionBegin(t);
+        for (int j = 0; j < ops; j++) {
+            int count = KheSolnMeetCount(soln);
+            randomOp(soln, instance);
+            if (KheSolnMeetCount(soln) > count) splits++;
+            if (KheSolnMeetCount(soln) < count) merges++;
+        }
+        KheTransactionEnd(t);
+        if (i % 2 == 0 || KheSolnMeetCount(soln) != meets) {
+            KheTransactionUndo(t);
+            if (!before.matches(soln, "random transaction")) return EXIT_FAILURE;
+            undone = true;
+        }
+        KheTransactionEnd(outer);
+
+        KHE_TRANSACTION replay = KheTransactionLogPortable(outer) ? outer : t;
+        if (replay == outer || !undone) {
+            log.resize(KheTransactionLogLength(replay) + 1);  // +1: log[0] existe mesmo vazio
+            KheTransactionLogExport(replay, &log[0]);
+            if (!KheSolnReplayLog(copy, &log[0], (int) log.size() - 1)) {
+                printf("random transaction %d: replay failed\n", i);
+                return EXIT_FAILURE;
+            }
+            replayed++;
+            if (undone) replayedUndos++;
+        }
+        KheTransactionDelete(t);
+        KheTransactionDelete(outer);
+        if (KheSolnAssignHash(copy) != KheSolnAssignHash(soln) || KheSolnCost(copy) != KheSolnCost(soln) ||
+                KheSolnMeetCount(copy) != KheSolnMeetCount(soln)) {
+            printf("random transaction %d: replayed copy differs from the solution\n", i);
+            return EXIT_FAILURE;
+        }
+    }
+    printf("random transactions: %d (%d splits, %d merges), %d logs replayed (%d with undo) OK\n", transactions,
+            splits, merges, replayed, replayedUndos);
+    return 0;
+}
@@ -150,6 +150,12 @@ OBJECTFILES= \
 	${OBJECTDIR}/stt_heur/khe/khe_first_resource.o \
 	${OBJECTDIR}/stt_heur/khe/khe_layer_solve.o \
 	${OBJECTDIR}/stt_heur/moves.o \
+	${OBJECTDIR}/stt_heur/bounds.o \
+	${OBJECTDIR}/stt_heur/replicas.o \
+	${OBJECTDIR}/stt_heur/telemetry.o \
+	${OBJECTDIR}/stt_heur/elite.o \
+	${OBJECTDIR}/stt_heur/solver.o \
+	${OBJECTDIR}/stt_heur/daemon.o \
 	${OBJECTDIR}/stt_heur/khe/khe_task_tree.o \
 	${OBJECTDIR}/stt_heur/khe/khe_spread_events_monitor.o \
 	${OBJECTDIR}/stt_heur/khe/khe_resource_type.o \
@@ -761,6 +767,36 @@ ${OBJECTDIR}/stt_heur/moves.o: stt_heur/moves.cpp
 	${RM} $@.d
 	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/moves.o stt_heur/moves.cpp
 
+${OBJECTDIR}/stt_heur/bounds.o: stt_heur/bounds.cpp 
+	${MKDIR} -p ${OBJECTDIR}/stt_heur
+	${RM} $@.d
+	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/bounds.o stt_heur/bounds.cpp
+
+${OBJECTDIR}/stt_heur/replicas.o: stt_heur/replicas.cpp 
+	${MKDIR} -p ${OBJECTDIR}/stt_heur
+	${RM} $@.d
+	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/replicas.o stt_heur/replicas.cpp
+
+${OBJECTDIR}/stt_heur/telemetry.o: stt_heur/telemetry.cpp 
+	${MKDIR} -p ${OBJECTDIR}/stt_heur
+	${RM} $@.d
+	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/telemetry.o stt_heur/telemetry.cpp
+
+${OBJECTDIR}/stt_heur/daemon.o: stt_heur/daemon.cpp 
+	${MKDIR} -p ${OBJECTDIR}/stt_heur
+	${RM} $@.d
+	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/daemon.o stt_heur/daemon.cpp
+
+${OBJECTDIR}/stt_heur/solver.o: stt_heur/solver.cpp 
+	${MKDIR} -p ${OBJECTDIR}/stt_heur
+	${RM} $@.d
+	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/solver.o stt_heur/solver.cpp
+
+${OBJECTDIR}/stt_heur/elite.o: stt_heur/elite.cpp 
+	${MKDIR} -p ${OBJECTDIR}/stt_heur
+	${RM} $@.d
+	$(COMPILE.cc) -g -MMD -MP -MF $@.d -o ${OBJECTDIR}/stt_heur/elite.o stt_heur/elite.cpp
+
 ${OBJECTDIR}/stt_heur/khe/khe_task_tree.o: stt_heur/khe/khe_task_tree.c 
 	${MKDIR} -p ${OBJECTDIR}/stt_heur/khe
 	${RM} $@.d
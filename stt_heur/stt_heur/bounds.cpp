@@ -0,0 +1,275 @@
+#include <iostream>
+#include <cstdio>
+#include <algorithm>
+#include "bounds.h"
+
+extern "C" {
+#include "khe/khe_interns.h"
+}
+
+using namespace std;
+
+Bounds bounds;
+
+//--------------------------------------------------------------------------
+
+static bool isRequired(KHE_CONSTRAINT c) {
+    return KheConstraintRequired(c) && KheConstraintWeight(c) > 0;
+}
+
+// custo minimo de um monitor com varios desvios cuja soma e ao menos dev,
+// seja qual for a reparticao deles
+static KHE_COST minMultiCost(KHE_CONSTRAINT c, int dev) {
+    if (dev <= 0) return 0;
+    switch (KheConstraintCostFunction(c)) {
+        case KHE_SUM_STEPS_COST_FUNCTION:
+        case KHE_STEP_SUM_COST_FUNCTION:
+            return KheConstraintCombinedWeight(c);
+        default:
+            return dev * KheConstraintCombinedWeight(c);
+    }
+}
+
+// o evento sempre tem horario nas solucoes sem custo hard de atribuicao
+static bool hasTime(KHE_EVENT e) {
+    if (KheEventPreassignedTime(e) != NULL) return true;
+    for (int i = 0; i < KheEventConstraintCount(e); i++) {
+        KHE_CONSTRAINT c = KheEventConstraint(e, i);
+        if (KheConstraintTag(c) == KHE_ASSIGN_TIME_CONSTRAINT_TAG && isRequired(c))
+            return true;
+    }
+    return false;
+}
+
+// o recurso nunca tem conflitos nas solucoes sem custo hard de conflito
+static bool hasHardClashes(KHE_RESOURCE r) {
+    bool found = false;
+    for (int i = 0; i < KheResourceConstraintCount(r); i++) {
+        KHE_CONSTRAINT c = KheResourceConstraint(r, i);
+        if (KheConstraintTag(c) != KHE_AVOID_CLASHES_CONSTRAINT_TAG) continue;
+        if (!isRequired(c)) return false;
+        found = true;
+    }
+    return found;
+}
+
+// nro de horarios fora dos grupos de horarios
+static int timesOutside(KHE_INSTANCE instance, vector< KHE_TIME_GROUP > &groups) {
+    vector< char > covered(KheInstanceTimeCount(instance), false);
+    int outside = KheInstanceTimeCount(instance);
+    for (int i = 0; i < groups.size(); i++) {
+        for (int j = 0; j < KheTimeGroupTimeCount(groups[i]); j++) {
+            int index = KheTimeIndex(KheTimeGroupTime(groups[i], j));
+            if (!covered[index]) {
+                covered[index] = true;
+                outside--;
+            }
+        }
+    }
+    return outside;
+}
+
+//--------------------------------------------------------------------------
+
+Bounds::Bounds() {
+    this->config = NULL;
+    this->copy = NULL;
+    this->known = this->resourceBound = this->matchingBound = 0;
+    this->incumbent = 0;
+    this->running = false;
+}
+
+Bounds::~Bounds() {
+    this->stop();
+}
+
+void Bounds::start(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    this->config = &config;
+    this->known = KheCost(0, config.lb);
+    this->resourceBound = this->computeResourceBound(instance);
+    this->matchingBound = 0;
+    this->incumbent = KheSolnCost(soln);
+
+    KHE_COST cost = this->bound();
+    printf("Lower bound: %d , %d\n", KheHardCost(cost), KheSoftCost(cost));
+
+    // KheSolnCopy altera campos da solucao de origem: fica na thread principal
+    this->copy = KheSolnCopy(soln);
+    this->running = true;
+    this->worker = thread(&Bounds::matchingLoop, this);
+}
+
+void Bounds::stop() {
+    if (!this->running) return;
+    this->worker.join();
+    KheSolnDelete(this->copy);
+    this->copy = NULL;
+    this->running = false;
+}
+
+KHE_COST Bounds::bound() {
+    // o limite por recurso so tem custo soft, e so vale quando o limite
+    // hard e 0, o que a comparacao de KHE_COST ja respeita
+    return max(this->known, max(this->resourceBound, this->matchingBound));
+}
+
+// Registra o custo da melhor solucao; se ele atinge o limite a busca para
+bool Bounds::reached(KHE_SOLN soln) {
+    lock_guard< mutex > guard(this->lock);
+    if (this->config == NULL) return false;
+    this->incumbent = min(this->incumbent, KheSolnCost(soln));
+    return this->checkReached();
+}
+
+bool Bounds::checkReached() {
+    if (this->incumbent > this->bound()) return false;
+    this->config->stop();
+    return true;
+}
+
+void Bounds::matchingLoop() {
+    KHE_COST cost = this->computeMatchingBound(this->copy);
+
+    lock_guard< mutex > guard(this->lock);
+    if (cost > this->matchingBound) {
+        KHE_COST before = this->bound();
+        this->matchingBound = cost;
+        if (this->bound() > before)
+            printf("Lower bound: %d , %d (matching)\n",
+                    KheHardCost(this->bound()), KheSoftCost(this->bound()));
+        this->checkReached();
+    }
+}
+
+// Limite pelos recursos pre-atribuidos. Sem conflitos e com todos os eventos
+// no horario, um recurso fica ocupado em pelo menos D horarios (a duracao dos
+// seus eventos) e com carga pelo menos W; dai saem desvios minimos das
+// restricoes de carga, indisponibilidade e limites de horarios ocupados.
+// Conta com as tarefas pre-atribuidas sempre com o seu recurso, como fazem
+// todos os movimentos. Se o limite tiver custo hard ele nao vale (uma solucao
+// com conflitos pode custar menos), e fica 0.
+KHE_COST Bounds::computeResourceBound(KHE_INSTANCE instance) {
+    KHE_COST total = 0;
+    int timeCount = KheInstanceTimeCount(instance);
+    vector< KHE_TIME_GROUP > groups;
+    vector< int > sizes;
+
+    for (int r = 0; r < KheInstanceResourceCount(instance); r++) {
+        KHE_RESOURCE resource = KheInstanceResource(instance, r);
+        if (!hasHardClashes(resource)) continue;
+
+        int duration = 0, workload = 0;
+        for (int i = 0; i < KheResourcePreassignedEventResourceCount(resource); i++) {
+            KHE_EVENT_RESOURCE er = KheResourcePreassignedEventResource(resource, i);
+            workload += KheEventResourceWorkload(er);
+            if (hasTime(KheEventResourceEvent(er)))
+                duration += KheEventDuration(KheEventResourceEvent(er));
+        }
+
+        for (int i = 0; i < KheResourceConstraintCount(resource); i++) {
+            KHE_CONSTRAINT c = KheResourceConstraint(resource, i);
+            switch (KheConstraintTag(c)) {
+                case KHE_LIMIT_WORKLOAD_CONSTRAINT_TAG: {
+                    int dev = workload - KheLimitWorkloadConstraintMaximum((KHE_LIMIT_WORKLOAD_CONSTRAINT) c);
+                    total += KheConstraintCost(c, max(0, dev));
+                    break;
+                }
+                case KHE_AVOID_UNAVAILABLE_TIMES_CONSTRAINT_TAG: {
+                    KHE_TIME_GROUP domain = KheAvoidUnavailableTimesConstraintDomain((KHE_AVOID_UNAVAILABLE_TIMES_CONSTRAINT) c);
+                    int dev = duration - (timeCount - KheTimeGroupTimeCount(domain));
+                    total += KheConstraintCost(c, max(0, dev));
+                    break;
+                }
+                case KHE_LIMIT_BUSY_TIMES_CONSTRAINT_TAG: {
+                    // cada grupo comporta o maximo sem desvio
+                    KHE_LIMIT_BUSY_TIMES_CONSTRAINT lbc = (KHE_LIMIT_BUSY_TIMES_CONSTRAINT) c;
+                    groups.clear();
+                    for (int j = 0; j < KheLimitBusyTimesConstraintTimeGroupCount(lbc); j++)
+                        groups.push_back(KheLimitBusyTimesConstraintTimeGroup(lbc, j));
+                    int dev = duration - timesOutside(instance, groups) -
+                            (int) groups.size() * KheLimitBusyTimesConstraintMaximum(lbc);
+                    total += minMultiCost(c, dev);
+                    break;
+                }
+                case KHE_CLUSTER_BUSY_TIMES_CONSTRAINT_TAG: {
+                    // menor nro de grupos que cobrem os horarios ocupados
+                    KHE_CLUSTER_BUSY_TIMES_CONSTRAINT cbc = (KHE_CLUSTER_BUSY_TIMES_CONSTRAINT) c;
+                    groups.clear();
+                    sizes.clear();
+                    for (int j = 0; j < KheClusterBusyTimesConstraintTimeGroupCount(cbc); j++) {
+                        groups.push_back(KheClusterBusyTimesConstraintTimeGroup(cbc, j));
+                        sizes.push_back(KheTimeGroupTimeCount(groups.back()));
+                    }
+                    sort(sizes.begin(), sizes.end(), greater< int >());
+                    int need = duration - timesOutside(instance, groups), busy = 0;
+                    for (int covered = 0; covered < need && busy < sizes.size(); busy++)
+                        covered += sizes[busy];
+                    int dev = busy - KheClusterBusyTimesConstraintMaximum(cbc);
+                    total += KheConstraintCost(c, max(0, dev));
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+    }
+
+    return KheHardCost(total) > 0 ? 0 : total;
+}
+
+// Limite pelo emparelhamento da KHE com o tipo EVAL_INITIAL, em que cada
+// meet pode ir a qualquer horario do seu dominio e cada tarefa a qualquer
+// recurso do seu: os nos de demanda sem par faltam em qualquer solucao, e
+// cada um custa ao menos um desvio hard de atribuicao, conflito ou carga.
+// So vale se todos esses desvios forem hard.
+KHE_COST Bounds::computeMatchingBound(KHE_SOLN soln) {
+    KHE_INSTANCE instance = KheSolnInstance(soln);
+    for (int i = 0; i < KheInstanceEventCount(instance); i++) {
+        KHE_EVENT e = KheInstanceEvent(instance, i);
+        if (!hasTime(e)) return 0;
+        for (int j = 0; j < KheEventResourceCount(e); j++) {
+            KHE_EVENT_RESOURCE er = KheEventResource(e, j);
+            if (KheEventResourcePreassignedResource(er) != NULL) continue;
+            bool assigned = false;
+            for (int k = 0; k < KheEventResourceConstraintCount(er) && !assigned; k++) {
+                KHE_CONSTRAINT c = KheEventResourceConstraint(er, k);
+                assigned = KheConstraintTag(c) == KHE_ASSIGN_RESOURCE_CONSTRAINT_TAG && isRequired(c);
+            }
+            if (!assigned) return 0;
+        }
+    }
+    for (int i = 0; i < KheInstanceResourceCount(instance); i++)
+        if (!hasHardClashes(KheInstanceResource(instance, i))) return 0;
+
+    // menor custo de um desvio, e se ele pode cobrir varios desvios
+    KHE_COST weight = -1;
+    bool step = false;
+    for (int i = 0; i < KheInstanceConstraintCount(instance); i++) {
+        KHE_CONSTRAINT c = KheInstanceConstraint(instance, i);
+        switch (KheConstraintTag(c)) {
+            case KHE_ASSIGN_TIME_CONSTRAINT_TAG:
+            case KHE_ASSIGN_RESOURCE_CONSTRAINT_TAG:
+            case KHE_AVOID_CLASHES_CONSTRAINT_TAG:
+            case KHE_AVOID_UNAVAILABLE_TIMES_CONSTRAINT_TAG:
+            case KHE_LIMIT_BUSY_TIMES_CONSTRAINT_TAG:
+            case KHE_LIMIT_WORKLOAD_CONSTRAINT_TAG:
+                if (!isRequired(c)) break;
+                if (weight == -1 || KheConstraintCombinedWeight(c) < weight)
+                    weight = KheConstraintCombinedWeight(c);
+                if (KheConstraintCostFunction(c) == KHE_SUM_STEPS_COST_FUNCTION ||
+                        KheConstraintCostFunction(c) == KHE_STEP_SUM_COST_FUNCTION)
+                    step = true;
+                break;
+            default:
+                break;
+        }
+    }
+    if (weight == -1) return 0;
+
+    KheSolnMatchingSetWeight(soln, KheCost(1, 0));
+    KheSolnMatchingSetType(soln, KHE_MATCHING_TYPE_EVAL_INITIAL);
+    KheSolnMatchingAttachAllOrdinaryDemandMonitors(soln);
+    KheSolnMatchingAddAllWorkloadRequirements(soln);
+    int unmatched = KheSolnMatchingDefectCount(soln);
+    return step ? (unmatched > 0 ? weight : 0) : unmatched * weight;
+}
@@ -0,0 +1,51 @@
+#ifndef bounds_h
+#define bounds_h
+
+#include <vector>
+#include <thread>
+#include <mutex>
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+#include "config.h"
+
+using namespace std;
+
+// Limite inferior para o custo de qualquer solucao da instancia.
+// Os limites por recurso (carga e limites de horarios dos recursos
+// pre-atribuidos) saem na hora; o limite do emparelhamento da KHE e
+// calculado numa copia da solucao por uma thread separada. Quando a melhor
+// solucao atinge o limite ela e otima, e a busca e encerrada (Config::stop).
+class Bounds {
+public:
+    Bounds();
+    ~Bounds();
+
+    void start(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+    void stop();
+
+    KHE_COST bound();
+    bool reached(KHE_SOLN soln);
+
+private:
+    Config *config;
+    KHE_SOLN copy;
+    thread worker;
+    mutex lock;
+    KHE_COST known;          // limite informado em -lb
+    KHE_COST resourceBound;
+    KHE_COST matchingBound;
+    KHE_COST incumbent;
+    bool running;
+
+    KHE_COST computeResourceBound(KHE_INSTANCE instance);
+    KHE_COST computeMatchingBound(KHE_SOLN soln);
+    void matchingLoop();
+    bool checkReached();
+};
+
+extern Bounds bounds;
+
+#endif
@@ -5,96 +5,247 @@ using namespace std;
 
 //--------------------------------------------------------------------------
 
+// Argumentos: opcoes -chave=valor (-xml=, -out=, -time_limit=, -seed= e as
+// demais) ou, por compatibilidade, os posicionais <xml> <saida> <tempo>
+// <semente> em qualquer posicao; sem modelo ou sem saida mostra o uso
 bool Config::setParameters(int argc, char *argv[]) {
-    this->xml = argv[1];
-    this->outPrefix = argv[2];
-    this->timeLimit = atoi(argv[3]);
-    this->seed = atoi(argv[4]);
-    
-    /*
+    int positional = 0;
+    for (int i = 1; i < argc; i++) {
+        if (argv[i][0] != '-') {
+            switch (positional++) {
+                case 0: this->xml = argv[i]; break;
+                case 1: this->outPrefix = argv[i]; break;
+                case 2: this->timeLimit = atoi(argv[i]); break;
+                case 3: this->seed = atoi(argv[i]); break;
+                default:
+                    this->usage(argv[0]);
+                    cerr << "ERROR: Unexpected argument: " << argv[i] << endl << endl;
+                    exit(EXIT_FAILURE);
+            }
+        } else if (!this->setOption(argv[i])) {
+            this->usage(argv[0]);
+            cerr << "ERROR: Invalid parameter: " << argv[i] << endl << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    if (this->xml == NULL || this->outPrefix == NULL) {
+        this->usage(argv[0]);
+        cerr << "ERROR: Missing " << (this->xml == NULL ? "-xml" : "-out") << endl << endl;
+        exit(EXIT_FAILURE);
+    }
     
+    // modo em lote: a semente e o modelo dos argumentos entram nas listas
+    if (!this->seeds.empty() || !this->xmls.empty()) {
+        if (this->seeds.empty())
+            this->seeds.push_back(this->seed);
+        this->xmls.insert(this->xmls.begin(), this->xml);
+    }
+    return true;
+}
+
+// Nomes das vizinhancas nas opcoes -nb_<nome>=peso, na ordem dos indices de
+// heuristics.h (o indice 0 nao e usado)
+static const char *neighborNames[] = {
+    "", "meet_swap", "task_swap", "task_resource_swap", "meet_block_swap",
+    "meet_time_change", "permut_resources", "kempe_times", "time_slot_swap",
+    "meet_split", "meet_merge", "two_colour_reassign"
+};
+
+// Aplica uma opcao -chave=valor; falso se a opcao nao existe. As strings
+// guardadas (arquivos) apontam para dentro de arg, que precisa durar.
+bool Config::setOption(char *arg) {
+    char chvalue[1000];
     int value;
     double dvalue;
-    char chvalue[1000];
     
-    //ITC requiriments
-//    sscanf(argv[0], "%s", this->xml);
-//    sscanf(argv[1], "%s", this->outPrefix);//this->outPrefix = argv[1];
-//    sscanf(argv[2], "%d", this->timeLimit);//this->timeLimit = argv[2];
-//    sscanf(argv[3], "%d", this->seed);//this->seed = argv[3];
-//    
-//    printf("%s %s %d %d\n", this->xml, this->outPrefix, this->timeLimit, this->seed);
+    if (sscanf(arg, "-config=%s", chvalue) == 1)
+        return this->readOptions(arg+8);
+    else if (sscanf(arg, "-xml=%s", chvalue) == 1)
+        this->xml = arg+5;
+    else if (sscanf(arg, "-out=%s", chvalue) == 1)
+        this->outPrefix = arg+5;
+    else if (sscanf(arg, "-time_limit=%d", &value) == 1)
+        this->timeLimit = value;
+    else if (sscanf(arg, "-seed=%d", &value) == 1)
+        this->seed = value;
+    else if (sscanf(arg, "-sol=%s", chvalue) == 1)
+        this->sol = arg+5;
+    else if (sscanf(arg, "-telemetry=%s", chvalue) == 1)
+        this->telemetry = arg+11;
+    else if (sscanf(arg, "-telemetry_interval=%d", &value) == 1)
+        this->telemetryInterval = value;
+    else if (sscanf(arg, "-threads=%d", &value) == 1)
+        this->threads = value;
+    else if (sscanf(arg, "-lb=%d", &value) == 1)
+        this->lb = value;
+    else if (sscanf(arg, "-seeds=%s", chvalue) == 1)
+        this->parseSeeds(arg+7);
+    else if (sscanf(arg, "-xmls=%s", chvalue) == 1)
+        this->parseXmls(arg+6);
+    
+    else if (sscanf(arg, "-sa_max=%d", &value) == 1)
+        this->saMax = value;
+    else if (sscanf(arg, "-sa_tempini=%lf", &dvalue) == 1)
+        this->saTempIni = dvalue;
+    else if (sscanf(arg, "-sa_tempmin=%lf", &dvalue) == 1)
+        this->saTempMin = dvalue;
+    else if (sscanf(arg, "-sa_alpha=%lf", &dvalue) == 1)
+        this->saAlpha = dvalue;
+    else if (sscanf(arg, "-sa_reheats=%d", &value) == 1)
+        this->saReheats = value;
+    else if (sscanf(arg, "-sa_calibrate=%d", &value) == 1)
+        this->saCalibrate = value;
+    else if (sscanf(arg, "-sa_samples=%d", &value) == 1)
+        this->saSamples = value;
+    else if (sscanf(arg, "-sa_minworse=%d", &value) == 1 && value > 0)
+        this->saMinWorse = value;
+    else if (sscanf(arg, "-sa_acceptini=%lf", &dvalue) == 1 && dvalue > 0 && dvalue < 1)
+        this->saAcceptIni = dvalue;
+    else if (sscanf(arg, "-sa_acceptend=%lf", &dvalue) == 1 && dvalue > 0 && dvalue < 1)
+        this->saAcceptEnd = dvalue;
+    else if (sscanf(arg, "-sa_timeshare=%d", &value) == 1)
+        this->saTimeShare = value;
+    
+    else if (sscanf(arg, "-ils_max=%d", &value) == 1)
+        this->ilsMax = value;
+    else if (sscanf(arg, "-ils_pertiter=%d", &value) == 1)
+        this->ilsIters = value;
+    else if (sscanf(arg, "-ils_blmax=%d", &value) == 1)
+        this->ilsBlMax = value;
+    else if (sscanf(arg, "-ils_pertini=%d", &value) == 1)
+        this->ilsPertIni = value;
+    else if (sscanf(arg, "-ils_pertmax=%d", &value) == 1)
+        this->ilsPertMax = value;
+    else if (sscanf(arg, "-best_descent=%d", &value) == 1)
+        this->bestDescent = value;
+    
+    else if (sscanf(arg, "-vns_max=%d", &value) == 1)
+        this->vnsMax = value;
     
-    // capturando parametros opcionais
-    for (int i = 1; i < argc; i++) {        
-        if (sscanf(argv[i], "-xml=%s", chvalue) == 1)
-            this->xml = argv[i]+5;
-        else if (sscanf(argv[i], "-sol=%s", chvalue) == 1)
-            this->sol = argv[i]+5;
-        else if (sscanf(argv[i], "-out=%s", chvalue) == 1)
-            this->outPrefix = argv[i]+5;
-        
-        else if (sscanf(argv[i], "-seed=%d", &value) == 1)
-            this->seed = value;
-        else if (sscanf(argv[i], "-threads=%d", &value) == 1)
-            this->threads = value;
-        else if (sscanf(argv[i], "-time_limit=%d", &value) == 1)
-            this->timeLimit = value;
-        else if (sscanf(argv[i], "-lb=%d", &value) == 1)
-            this->lb = value;
-        
-        else if (sscanf(argv[i], "-sa_max=%d", &value) == 1)
-            this->saMax = value;
-        else if (sscanf(argv[i], "-sa_tempini=%lf", &dvalue) == 1)
-            this->saTempIni = dvalue;
-        else if (sscanf(argv[i], "-sa_tempmin=%lf", &dvalue) == 1)
-            this->saTempMin = dvalue;
-        else if (sscanf(argv[i], "-sa_alpha=%lf", &dvalue) == 1)
-            this->saAlpha = dvalue;
-        else if (sscanf(argv[i], "-sa_reheats=%d", &value) == 1)
-            this->saReheats = value;
-        
-        else if (sscanf(argv[i], "-ils_max=%d", &value) == 1)
-            this->ilsMax = value;
-        else if (sscanf(argv[i], "-ils_pertiter=%d", &value) == 1)
-            this->ilsIters = value;
-        else if (sscanf(argv[i], "-ils_blmax=%d", &value) == 1)
-            this->ilsBlMax = value;
-        else if (sscanf(argv[i], "-ils_pertini=%d", &value) == 1)
-            this->ilsPertIni = value;
-        else if (sscanf(argv[i], "-ils_pertmax=%d", &value) == 1)
-            this->ilsPertMax = value;
+    else if (sscanf(arg, "-kempe_threads=%d", &value) == 1)
+        this->kempeThreads = value;
+    else if (sscanf(arg, "-tabu=%d", &value) == 1)
+        this->tabu = value;
+    else if (sscanf(arg, "-tabu_max=%d", &value) == 1)
+        this->tabuMax = value;
+    else if (sscanf(arg, "-tabu_candidates=%d", &value) == 1)
+        this->tabuCandidates = value;
+    else if (sscanf(arg, "-tabu_tenure=%d", &value) == 1)
+        this->tabuTenure = value;
+    else if (sscanf(arg, "-lns=%d", &value) == 1)
+        this->lns = value;
+    else if (sscanf(arg, "-lns_attempts=%d", &value) == 1)
+        this->lnsAttempts = value;
+    
+    else if (sscanf(arg, "-elite=%d", &value) == 1)
+        this->elite = value;
+    else if (sscanf(arg, "-elite_distance=%d", &value) == 1)
+        this->eliteDistance = value;
+    else if (sscanf(arg, "-elite_every=%d", &value) == 1 && value > 0)
+        this->eliteEvery = value;
+    else if (sscanf(arg, "-elite_relinks=%d", &value) == 1)
+        this->eliteRelinks = value;
+    else if (sscanf(arg, "-relink_candidates=%d", &value) == 1 && value > 0)
+        this->relinkCandidates = value;
+    
+    else if (strncmp(arg, "-nb_", 4) == 0) {
+        for (int i = 1; i < this->neighborWeights.size(); i++) {
+            int length = strlen(neighborNames[i]);
+            if (strncmp(arg+4, neighborNames[i], length) == 0 && arg[4+length] == '='
+                    && sscanf(arg+5+length, "%d", &value) == 1 && value >= 0) {
+                this->neighborWeights[i] = value;
+                return true;
+            }
+        }
+        return false;
+    } else
+        return false;
+    return true;
+}
 
-        else if (sscanf(argv[i], "-vns_max=%d", &value) == 1)
-            this->ilsMax = value;
-             
-        else {
-            this->usage(argv[0]);
-            cerr << "ERROR: Invalid parameter: " << argv[i] << endl << endl;
-            exit(EXIT_FAILURE);
+// Arquivo de configuracao: uma opcao -chave=valor por linha (o '-' inicial
+// e opcional); linhas vazias e comentarios com '#' sao ignorados. Um
+// -config= pode incluir outro arquivo, mas nao um que ja esteja sendo lido.
+bool Config::readOptions(const char *fname) {
+    FILE *fp = fopen(fname, "r");
+    if (fp == NULL) {
+        cerr << "ERROR: cannot open configuration file " << fname << endl;
+        return false;
+    }
+    char *path = realpath(fname, NULL);
+    for (int i = 0; path != NULL && i < this->configFiles.size(); i++) {
+        if (this->configFiles[i] == path) {
+            cerr << "ERROR: configuration file " << fname << " includes itself" << endl;
+            free(path);
+            fclose(fp);
+            return false;
         }
     }
+    this->configFiles.push_back(path != NULL ? path : fname);
+    free(path);
     
-    // verificando se os parametros obrigatorios foram fornecidos
-    if (!this->xml || !this->outPrefix) {
-        this->usage(argv[0]);
-        cerr << "ERROR: You must inform the parameters -xml and -out" << endl << endl;
-        exit(EXIT_FAILURE);
+    char line[1024], option[1025];
+    bool ok = true;
+    while (ok && fgets(line, sizeof(line), fp) != NULL) {
+        char word[1024];
+        if (sscanf(line, "%1023s", word) != 1 || word[0] == '#')
+            continue;
+        snprintf(option, sizeof(option), "%s%s", word[0] == '-' ? "" : "-", word);
+        // as opcoes guardam ponteiros para a string, que fica com a Config
+        ok = this->setOption(strdup(option));
+        if (!ok)
+            cerr << "ERROR: Invalid parameter in " << fname << ": " << word << endl;
     }
-    */
-    return true;
-     
+    fclose(fp);
+    this->configFiles.pop_back();
+    return ok;
+}
+
+// Lista de sementes separadas por virgulas, com intervalos a-b
+void Config::parseSeeds(const char *list) {
+    int first, last, used;
+    while (*list) {
+        if (sscanf(list, "%d-%d%n", &first, &last, &used) == 2 && first <= last) {
+            for (int s = first; s <= last; s++)
+                this->seeds.push_back(s);
+        } else if (sscanf(list, "%d%n", &first, &used) == 1) {
+            this->seeds.push_back(first);
+        } else {
+            cerr << "ERROR: Invalid seed list: " << list << endl << endl;
+            exit(EXIT_FAILURE);
+        }
+        list += used;
+        if (*list == ',') list++;
+    }
+}
+
+// Lista de modelos separados por virgulas (as strings ficam em argv)
+void Config::parseXmls(char *list) {
+    for (char *xml = strtok(list, ","); xml != NULL; xml = strtok(NULL, ","))
+        this->xmls.push_back(xml);
+}
+
+bool Config::isBatch() {
+    return !this->seeds.empty();
 }
 
 void Config::usage (const char *progname) {
     cerr << endl;
-    cerr << "Usage: " << progname << " [arguments] [options]" << endl;
+    cerr << "Usage: " << progname << " -xml=input.xml -out=output [options]" << endl;
+    cerr << "   or: " << progname << " input.xml output time_limit seed [options]" << endl;
     cerr << endl;
     cerr << "Program arguments:" << endl;
     cerr << "    -xml=input.xml  : nurse problem" << endl;
-    cerr << "    -sol=input.sol  : solution file" << endl;
+    cerr << "    -sol=input.sol  : solution file to start from (our output or any XHSTT" << endl;
+    cerr << "                      solution group or archive); the best solution of the" << endl;
+    cerr << "                      instance is used and the search state saved beside it" << endl;
+    cerr << "                      in input.sol.state, if any, is resumed" << endl;
     cerr << "    -out=output     : prefix of files where the solutions and logs will be saved" << endl;
     cerr << endl;
+    cerr << "Daemon mode (" << progname << " -daemon=/tmp/stt.sock [-workers=2]):" << endl;
+    cerr << "    keeps the instances loaded and runs solve jobs sent over the Unix socket," << endl;
+    cerr << "    up to -workers at a time (see daemon.h for the protocol)" << endl;
+    cerr << endl;
     cerr << "Optional parameters (example):" << endl;
     cerr << "    -seed=333       : seed for random number generator" << endl;
     cerr << "                      default value = 33" << endl;
@@ -104,20 +255,65 @@ void Config::usage (const char *progname) {
     cerr << "                      default value = 0 (unlimited)" << endl;
     cerr << "    -lb=0           : value of the best known lower bound (or global optimum)." << endl;
     cerr << "                      default value = 0" << endl;
+    cerr << "                      the search stops once this (soft cost, no hard cost) or the" << endl;
+    cerr << "                      bound computed from the instance is reached" << endl;
+    cerr << "    -seeds=1,2,5-8  : batch mode, runs each seed in turn from a copy of the" << endl;
+    cerr << "                      initial solution (each with the full time limit) and" << endl;
+    cerr << "                      writes output.<seed>" << endl;
+    cerr << "    -xmls=b.xml,c.xml : batch mode over these instances too, each parsed once;" << endl;
+    cerr << "                      writes output.<instance id>.<seed>" << endl;
+    cerr << "    -telemetry=a.csv : samples the cost of each monitor type into a.csv." << endl;
+    cerr << "    -telemetry_interval=1000 : interval between samples (in milliseconds)." << endl;
+    cerr << "                    " << endl;
+    cerr << "    -config=a.cfg   : reads options from a.cfg, one -key=value per line (as" << endl;
+    cerr << "                      written by bench/race_tuner.py)" << endl;
+    cerr << "                    " << endl;
+    cerr << "    -sa_max=10000   : iterations per temperature level" << endl;
+    cerr << "    -sa_tempini=1   " << endl;
+    cerr << "    -sa_tempmin=0.1 " << endl;
+    cerr << "    -sa_alpha=0.97  " << endl;
+    cerr << "    -sa_reheats=5   " << endl;
+    cerr << "    -sa_calibrate=1 : sets the temperatures from sampled moves and fits the cooling" << endl;
+    cerr << "                      to the time left (0: fixed -sa_tempini/-sa_tempmin/-sa_alpha)" << endl;
+    cerr << "    -sa_samples=2000 : moves sampled by the calibration" << endl;
+    cerr << "    -sa_minworse=30 : soft-only worsenings needed to calibrate; sampling goes on up to" << endl;
+    cerr << "                      10x -sa_samples to find them (fewer: uncalibrated SA)" << endl;
+    cerr << "    -sa_acceptini=0.5 : acceptance of an average soft worsening when a cycle starts" << endl;
+    cerr << "    -sa_acceptend=0.005 : and when it ends" << endl;
+    cerr << "    -sa_timeshare=50 : % of the time left given to the calibrated SA (the rest to ILS)" << endl;
+    cerr << "                    " << endl;
+    cerr << "    -ils_max=10000  : ILS iterations without improvement per perturbation round" << endl;
+    cerr << "    -ils_blmax=1000000 : iterations of each descent" << endl;
+    cerr << "    -ils_pertini=1  " << endl;
+    cerr << "    -ils_pertmax=10 " << endl;
+    cerr << "    -ils_pertiter=50 : perturbation rounds" << endl;
+    cerr << "    -best_descent=1 : ILS descent takes the best defect meet swaps each round" << endl;
+    cerr << "                      (evaluated over -threads)" << endl;
     cerr << "                    " << endl;
-    cerr << "    -sa_time=0      " << endl;
-    cerr << "    -sa_max=0       " << endl;
-    cerr << "    -sa_tempini=0   " << endl;
-    cerr << "    -sa_tempmin=0   " << endl;
-    cerr << "    -sa_apha=0      " << endl;
-    cerr << "    -sa_reheats=0   " << endl;
+    cerr << "    -vns_max=5000   " << endl;
+    cerr << "    -kempe_threads=4 : evaluates Kempe chains on 4 solution copies" << endl;
     cerr << "                    " << endl;
-    cerr << "    -ils_time=0     " << endl;
-    cerr << "    -ils_max=0      " << endl;
-    cerr << "    -ils_blmax=0    " << endl;
-    cerr << "    -ils_pertini=0  " << endl;
-    cerr << "    -ils_pertmax=0  " << endl;
-    cerr << "    -ils_pertiter=0 " << endl;
+    cerr << "    -tabu=1         : runs tabu search instead of SA + ILS" << endl;
+    cerr << "    -tabu_max=0     " << endl;
+    cerr << "    -tabu_candidates=0 " << endl;
+    cerr << "    -tabu_tenure=0  " << endl;
+    cerr << "                    " << endl;
+    cerr << "    -lns=1          : runs large neighbourhood search instead of SA + ILS" << endl;
+    cerr << "    -lns_attempts=4 : destroy/repair attempts per round (spread over -threads)" << endl;
+    cerr << "                    " << endl;
+    cerr << "    -elite=10       : keeps the 10 best distinct local optima and path-relinks" << endl;
+    cerr << "                      pairs of them during ILS (default 0: off)" << endl;
+    cerr << "    -elite_distance=10 : least number of differing assignments between them" << endl;
+    cerr << "    -elite_every=10 : ILS iterations between path relinking rounds" << endl;
+    cerr << "    -elite_relinks=0 : pairs relinked per round, spread over -threads (0: one per thread)" << endl;
+    cerr << "    -relink_candidates=16 : assignments evaluated at each step of a path" << endl;
+    cerr << "                    " << endl;
+    cerr << "    -nb_<move>=2000 : relative weight of a move in the random neighbourhood draw;" << endl;
+    cerr << "                      the moves not given keep their default share. Moves:" << endl;
+    cerr << "                     ";
+    for (int i = 1; i < sizeof(neighborNames) / sizeof(neighborNames[0]); i++)
+        cerr << " " << neighborNames[i];
+    cerr << endl;
     cerr << endl;
 }
 
@@ -126,5 +322,11 @@ int Config::getRunTime() {
 }
 
 int Config::getRemainingTime() {
+    if (this->stopped) return 0;
     return this->timeLimit - (int) (time(NULL) - this->timeIni);
 }
+
+// encerra a busca antes do tempo limite (a solucao atingiu o lower bound)
+void Config::stop() {
+    this->stopped = true;
+}
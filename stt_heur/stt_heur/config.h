@@ -5,24 +5,58 @@
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
+#include <atomic>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+// Estado da busca que pode ser retomado: gravado junto da solucao de saida
+// (<saida>.state) e lido de novo com -sol
+class SearchState {
+public:
+    double saTemp;      // temperatura corrente do SA (0: comeca em saTempIni)
+    int saReheats;      // reaquecimentos ja feitos pelo SA
+    int ilsPerturbation; // nivel de perturbacao do ILS (0: comeca em ilsPertIni)
+    
+    SearchState() {
+        this->saTemp = 0;
+        this->saReheats = -1;
+        this->ilsPerturbation = 0;
+    }
+};
 
 class Config {
 public:
     char *xml;       // modelo de entrada
     char *sol;       // arquivo com solucoes
     char *outPrefix; // arquivo(s) de saida
+    std::vector< char * > xmls; // modelos do modo em lote (o primeiro e xml)
     
     int seed;        // semente de nros aleatorios
+    std::vector< int > seeds; // sementes do modo em lote
     int threads;     // nro de threads
     int timeIni;     // marca tempo de inicio da execucao
     int timeLimit;   // tempo limite de execucao (em minutos)
     int lb;          // melhor lower bound conhecido para a instancia
+    std::atomic< bool > stopped; // limite inferior atingido: busca encerrada
+    
+    char *telemetry;        // arquivo CSV com a serie temporal de custos
+    int telemetryInterval;  // intervalo entre amostras (em milissegundos)
     
     int saMax;
     int saReheats;
     double saTempIni;
     double saTempMin;
     double saAlpha;
+    int saCalibrate;    // temperaturas e resfriamento calibrados pela instancia e pelo tempo
+    int saSamples;      // movimentos amostrados na calibracao
+    int saMinWorse;     // pioras soft minimas para calibrar (senao, saTempIni/saTempMin)
+    double saAcceptIni; // aceitacao de uma piora soft media no inicio de cada ciclo
+    double saAcceptEnd; // e no fim dele
+    int saTimeShare;    // % do tempo restante dado ao SA calibrado (o resto e do ILS)
     
     int ilsMax;
     int ilsIters;
@@ -30,10 +64,39 @@ public:
     int ilsPertIni;
     int ilsPertMax;
     
+    int bestDescent;    // descida por melhor melhora nas trocas de meets em defeito
+    
     int vnsMax;
     
+    int kempeThreads;   // threads para avaliar as cadeias de Kempe
+    
+    int tabu;           // executa a busca tabu no lugar de SA + ILS
+    int tabuMax;        // iteracoes sem melhora antes de voltar a melhor solucao
+    int tabuCandidates; // movimentos avaliados por iteracao
+    int tabuTenure;     // iteracoes em que um atributo fica tabu
+    
+    int lns;            // executa a LNS no lugar de SA + ILS
+    int lnsAttempts;    // destruicoes/reconstrucoes avaliadas por rodada
+    
+    int elite;          // tamanho do pool de elite (0: sem pool nem path relinking)
+    int eliteDistance;  // distancia minima (atribuicoes) entre solucoes do pool
+    int eliteEvery;     // iteracoes do ILS entre rodadas de path relinking
+    int eliteRelinks;   // pares do pool religados por rodada (0: um por thread)
+    int relinkCandidates; // atribuicoes avaliadas em cada passo do caminho
+    
     int assignResourcesConst;
     
+    // peso de cada vizinhanca no sorteio (MAX_NEIGHBOR + 1 posicoes, com os
+    // indices de heuristics.h; -1: peso padrao da instancia)
+    std::vector< int > neighborWeights;
+    
+    SearchState state;  // retomado de -sol e atualizado pela busca
+    
+    std::vector< std::string > configFiles; // arquivos -config= sendo lidos (aninhados)
+    
+    // chamada a cada melhora da solucao (eventos dos jobs do daemon)
+    void (*improved)(KHE_SOLN soln, Config &config);
+    
     Config() {
         this->xml = NULL;                 
         this->sol = NULL;                 
@@ -44,12 +107,22 @@ public:
         this->timeIni = (int) time(NULL); 
         this->timeLimit = 1000;            
         this->lb = 0;                     
+        this->stopped = false;
+        
+        this->telemetry = NULL;
+        this->telemetryInterval = 1000;
         
         this->saMax = 10000;
         this->saReheats = 5;
         this->saTempIni = 1.0;
         this->saTempMin = 0.1;
         this->saAlpha = 0.97;
+        this->saCalibrate = true;
+        this->saSamples = 2000;
+        this->saMinWorse = 30;
+        this->saAcceptIni = 0.5;
+        this->saAcceptEnd = 0.005;
+        this->saTimeShare = 50;
         
         this->ilsMax = 10000;
         this->ilsIters = 50;
@@ -57,15 +130,43 @@ public:
         this->ilsPertIni = 1;
         this->ilsPertMax = 10;
         
+        this->bestDescent = false;
+        
         this->vnsMax = 5000;
         
+        this->kempeThreads = 1;
+        
+        this->tabu = false;
+        this->tabuMax = 1000;
+        this->tabuCandidates = 256;
+        this->tabuTenure = 10;
+        
+        this->lns = false;
+        this->lnsAttempts = 4;
+        
+        this->elite = 0;
+        this->eliteDistance = 10;
+        this->eliteEvery = 10;
+        this->eliteRelinks = 0;
+        this->relinkCandidates = 16;
+        
         this->assignResourcesConst = false;
+        
+        this->neighborWeights.assign(12, -1);
+        
+        this->improved = NULL;
     }
     
     bool setParameters(int argc, char *argv[]);
+    bool setOption(char *arg);
+    bool readOptions(const char *fname);
+    bool isBatch();
+    void parseSeeds(const char *list);
+    void parseXmls(char *list);
     void usage(const char *progname);
     int getRunTime();
     int getRemainingTime();
+    void stop();
 };
 
 #endif
@@ -0,0 +1,347 @@
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdarg>
+#include <csignal>
+#include <sstream>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include "daemon.h"
+#include "solver.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+
+// estado do processo filho que executa um job
+static Config *jobConfig = NULL;
+static int jobClient = -1;
+static int jobId = -1;
+
+static void sendLine(int fd, const char *format, ...) {
+    char line[1024];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (fd < 0 || length <= 0) return;
+    if (length >= sizeof(line)) length = sizeof(line) - 1;
+    for (int sent = 0, n; sent < length; sent += n)
+        if ((n = write(fd, line + sent, length - sent)) <= 0) return;
+}
+
+static void jobImproved(KHE_SOLN soln, Config &config) {
+    KHE_COST cost = KheSolnCost(soln);
+    sendLine(jobClient, "IMPROVED %d %d %d %d\n", jobId, config.getRunTime(), KheHardCost(cost), KheSoftCost(cost));
+}
+
+// SIGTERM no filho: a busca termina como se o tempo tivesse acabado
+static void stopJob(int signal) {
+    if (jobConfig != NULL)
+        jobConfig->stop();
+}
+
+//--------------------------------------------------------------------------
+
+Daemon::Daemon() {
+    this->server = -1;
+    this->workers = 1;
+    this->nextJob = 1;
+    this->finished = false;
+}
+
+int Daemon::run(const char *path, int workers) {
+    struct sockaddr_un address;
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        cerr << "ERROR: socket path too long: " << path << endl;
+        return EXIT_FAILURE;
+    }
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, path);
+
+    this->server = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path);
+    if (this->server < 0 || bind(this->server, (struct sockaddr *) &address, sizeof(address)) < 0
+            || listen(this->server, 16) < 0) {
+        perror("daemon");
+        return EXIT_FAILURE;
+    }
+    this->workers = max(1, workers);
+    signal(SIGPIPE, SIG_IGN);
+    printf("Listening on %s (%d workers)\n", path, this->workers);
+    fflush(stdout);
+
+    while (!this->finished) {
+        vector< struct pollfd > fds(1);
+        fds[0].fd = this->server;
+        fds[0].events = POLLIN;
+        for (map< int, string >::iterator it = this->buffers.begin(); it != this->buffers.end(); it++) {
+            struct pollfd client;
+            client.fd = it->first;
+            client.events = POLLIN;
+            fds.push_back(client);
+        }
+        // o tempo limite do poll e o atraso maximo para notar um job terminado
+        poll(fds.data(), fds.size(), 200);
+
+        this->reapJobs();
+        this->startJobs();
+        if (fds[0].revents & POLLIN)
+            this->acceptClient();
+        for (int i = 1; i < fds.size() && !this->finished; i++) {
+            if (!this->buffers.count(fds[i].fd)) continue;
+            if (fds[i].revents & (POLLIN | POLLHUP | POLLERR))
+                if (!this->readClient(fds[i].fd))
+                    this->closeClient(fds[i].fd);
+        }
+    }
+
+    // encerramento: os jobs em execucao gravam a melhor solucao e terminam
+    for (int i = 0; i < this->running.size(); i++)
+        kill(this->running[i].pid, SIGTERM);
+    while (!this->running.empty()) {
+        int status;
+        pid_t pid = waitpid(-1, &status, 0);
+        if (pid < 0) break;
+        for (int i = 0; i < this->running.size(); i++)
+            if (this->running[i].pid == pid)
+                this->running.erase(this->running.begin() + i);
+    }
+    while (!this->buffers.empty())
+        this->closeClient(this->buffers.begin()->first);
+    close(this->server);
+    unlink(path);
+    return EXIT_SUCCESS;
+}
+
+void Daemon::acceptClient() {
+    int client = accept(this->server, NULL, NULL);
+    if (client >= 0)
+        this->buffers[client] = "";
+}
+
+// Le o que chegou do cliente e executa as linhas completas; falso se a
+// conexao terminou
+bool Daemon::readClient(int client) {
+    char data[4096];
+    int n = read(client, data, sizeof(data));
+    if (n <= 0) return false;
+
+    this->buffers[client].append(data, n);
+    size_t end;
+    while (this->buffers.count(client) && (end = this->buffers[client].find('\n')) != string::npos) {
+        string line = this->buffers[client].substr(0, end);
+        this->buffers[client].erase(0, end + 1);
+        if (!line.empty() && line[line.size() - 1] == '\r')
+            line.erase(line.size() - 1);
+        this->command(client, line);
+    }
+    return true;
+}
+
+// Fecha a conexao e cancela os jobs do cliente, que nao teria quem os ouvisse
+void Daemon::closeClient(int client) {
+    for (int i = 0; i < this->running.size(); i++)
+        if (this->running[i].client == client) {
+            kill(this->running[i].pid, SIGTERM);
+            this->running[i].client = -1;
+        }
+    for (int i = this->queued.size() - 1; i >= 0; i--)
+        if (this->queued[i].client == client)
+            this->queued.erase(this->queued.begin() + i);
+    close(client);
+    this->buffers.erase(client);
+}
+
+void Daemon::command(int client, const string &line) {
+    vector< string > words;
+    istringstream in(line);
+    for (string word; in >> word;)
+        words.push_back(word);
+    if (words.empty()) return;
+
+    if (words[0] == "LOAD")
+        this->load(client, words);
+    else if (words[0] == "SOLVE")
+        this->solve(client, words);
+    else if (words[0] == "CANCEL")
+        this->cancel(client, words);
+    else if (words[0] == "JOBS")
+        this->listJobs(client);
+    else if (words[0] == "SHUTDOWN") {
+        sendLine(client, "BYE\n");
+        this->finished = true;
+    } else
+        sendLine(client, "ERROR unknown command %s\n", words[0].c_str());
+}
+
+// Le a instancia uma unica vez; ler de novo o mesmo id substitui a anterior
+// (que nao e liberada: a KHE nao apaga arquivos)
+void Daemon::load(int client, vector< string > &words) {
+    if (words.size() != 2) {
+        sendLine(client, "ERROR usage: LOAD <xml>\n");
+        return;
+    }
+    DaemonInstance instance;
+    instance.xml = words[1];
+    instance.soln = ReadInstance(words[1].c_str(), instance.archive, instance.instance, false);
+    fflush(stdout);
+    if (instance.soln == NULL) {
+        sendLine(client, "ERROR cannot read %s\n", words[1].c_str());
+        return;
+    }
+    this->instances[KheInstanceId(instance.instance)] = instance;
+    sendLine(client, "LOADED %s\n", KheInstanceId(instance.instance));
+}
+
+void Daemon::solve(int client, vector< string > &words) {
+    if (words.size() < 5) {
+        sendLine(client, "ERROR usage: SOLVE <instance> <output> <time> <seed> [options]\n");
+        return;
+    }
+    if (!this->instances.count(words[1])) {
+        sendLine(client, "ERROR instance %s not loaded\n", words[1].c_str());
+        return;
+    }
+    DaemonJob job;
+    job.id = this->nextJob++;
+    job.client = client;
+    job.instance = words[1];
+    job.args.assign(words.begin() + 2, words.end());
+    job.pid = -1;
+    this->queued.push_back(job);
+    sendLine(client, "QUEUED %d\n", job.id);
+}
+
+void Daemon::cancel(int client, vector< string > &words) {
+    int id = words.size() == 2 ? atoi(words[1].c_str()) : -1;
+    for (int i = 0; i < this->running.size(); i++)
+        if (this->running[i].id == id) {
+            kill(this->running[i].pid, SIGTERM);
+            sendLine(client, "CANCELLING %d\n", id);
+            return;
+        }
+    for (int i = 0; i < this->queued.size(); i++)
+        if (this->queued[i].id == id) {
+            sendLine(client, "CANCELLING %d\n", id);
+            sendLine(this->queued[i].client, "FAILED %d\n", id);
+            this->queued.erase(this->queued.begin() + i);
+            return;
+        }
+    sendLine(client, "ERROR no job %s\n", words.size() == 2 ? words[1].c_str() : "");
+}
+
+void Daemon::listJobs(int client) {
+    for (int i = 0; i < this->running.size(); i++)
+        sendLine(client, "JOB %d %s running\n", this->running[i].id, this->running[i].instance.c_str());
+    for (int i = 0; i < this->queued.size(); i++)
+        sendLine(client, "JOB %d %s queued\n", this->queued[i].id, this->queued[i].instance.c_str());
+    sendLine(client, "END\n");
+}
+
+void Daemon::startJobs() {
+    while (!this->queued.empty() && this->running.size() < this->workers) {
+        DaemonJob job = this->queued.front();
+        this->queued.pop_front();
+        sendLine(job.client, "STARTED %d\n", job.id);
+        fflush(stdout);
+
+        // um CANCEL logo apos o STARTED nao pode matar o filho antes de ele
+        // instalar stopJob: SIGTERM fica bloqueado ate la (runJob o libera)
+        sigset_t term, previous;
+        sigemptyset(&term);
+        sigaddset(&term, SIGTERM);
+        sigprocmask(SIG_BLOCK, &term, &previous);
+        job.pid = fork();
+        if (job.pid == 0)
+            this->runJob(job);
+        sigprocmask(SIG_SETMASK, &previous, NULL);
+        if (job.pid < 0) {
+            sendLine(job.client, "FAILED %d\n", job.id);
+            continue;
+        }
+        this->running.push_back(job);
+    }
+}
+
+// Recolhe os filhos que terminaram; um job que nao terminou normalmente
+// (opcao invalida, erro da KHE) e relatado como FAILED
+void Daemon::reapJobs() {
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        for (int i = 0; i < this->running.size(); i++) {
+            if (this->running[i].pid != pid) continue;
+            if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+                sendLine(this->running[i].client, "FAILED %d\n", this->running[i].id);
+            this->running.erase(this->running.begin() + i);
+            break;
+        }
+    }
+}
+
+// Executa o job no processo filho: a instancia e a solucao inicial herdadas
+// do daemon sao usadas diretamente, ja que a memoria do filho e so dele
+void Daemon::runJob(DaemonJob &job) {
+    close(this->server);
+    for (map< int, string >::iterator it = this->buffers.begin(); it != this->buffers.end(); it++)
+        if (it->first != job.client)
+            close(it->first);
+    if (freopen("/dev/null", "w", stdout) == NULL)
+        _exit(EXIT_FAILURE);
+
+    DaemonInstance &instance = this->instances[job.instance];
+    vector< char * > argv;
+    argv.push_back((char *) "stt");
+    argv.push_back((char *) instance.xml.c_str());
+    for (int i = 0; i < job.args.size(); i++)
+        argv.push_back((char *) job.args[i].c_str());
+    argv.push_back(NULL);
+
+    Config config;
+    config.setParameters(argv.size() - 1, argv.data());
+    config.improved = jobImproved;
+    jobConfig = &config;
+    jobClient = job.client;
+    jobId = job.id;
+    signal(SIGTERM, stopJob);
+    sigset_t term;
+    sigemptyset(&term);
+    sigaddset(&term, SIGTERM);
+    sigprocmask(SIG_UNBLOCK, &term, NULL);
+    srand(config.seed);
+
+    KHE_SOLN_GROUP solg = MakeSolnGroup(instance.archive, config);
+    KHE_SOLN soln = StartSoln(instance.soln, instance.archive, instance.instance, config);
+    soln = Solve(soln, instance.instance, config);
+    WriteSoln(solg, soln, config.outPrefix);
+    WriteSearchState(config.state, config.outPrefix);
+
+    KHE_COST cost = KheSolnCost(soln);
+    sendLine(jobClient, "DONE %d %d %d\n", jobId, KheHardCost(cost), KheSoftCost(cost));
+    _exit(EXIT_SUCCESS);
+}
+
+//--------------------------------------------------------------------------
+
+// stt -daemon=<socket> [-workers=N]
+int runDaemon(int argc, char **argv) {
+    char path[1000];
+    int workers = 1, value;
+    if (sscanf(argv[1], "-daemon=%999s", path) != 1) return EXIT_FAILURE;
+    for (int i = 2; i < argc; i++) {
+        if (sscanf(argv[i], "-workers=%d", &value) == 1)
+            workers = value;
+        else {
+            cerr << "ERROR: Invalid parameter: " << argv[i] << endl << endl;
+            return EXIT_FAILURE;
+        }
+    }
+    Daemon daemon;
+    return daemon.run(path, workers);
+}
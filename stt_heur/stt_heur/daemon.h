@@ -0,0 +1,90 @@
+#ifndef daemon_h
+#define daemon_h
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <sys/types.h>
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+#include "config.h"
+
+using namespace std;
+
+// Instancia lida uma vez e mantida pelo daemon, com a solucao inicial do
+// arquivo
+class DaemonInstance {
+public:
+    string xml;
+    KHE_ARCHIVE archive;
+    KHE_INSTANCE instance;
+    KHE_SOLN soln;
+};
+
+// Busca pedida por um cliente: os argumentos sao os da linha de comando
+// (saida, tempo, semente e opcoes)
+class DaemonJob {
+public:
+    int id;
+    int client;
+    string instance;
+    vector< string > args;
+    pid_t pid;      // processo que executa o job (-1 enquanto na fila)
+};
+
+// Servidor residente num socket Unix local. Mantem as instancias ja lidas e
+// executa jobs de busca sobre elas. Cada job roda num processo filho, que
+// herda a instancia lida (sem copiar nem reler) e tem o seu proprio estado
+// global da busca; ate `workers` jobs rodam ao mesmo tempo e os demais
+// esperam na fila. Cancelar um job encerra a busca, que ainda grava a
+// melhor solucao.
+//
+// Protocolo em linhas de texto, campos separados por espacos:
+//   LOAD <xml>             -> LOADED <id da instancia> | ERROR <motivo>
+//   SOLVE <id> <saida> <tempo> <semente> [opcoes]
+//                          -> QUEUED <job>, e depois STARTED <job>,
+//                             IMPROVED <job> <tempo> <hard> <soft> (a cada
+//                             melhora) e DONE <job> <hard> <soft> ou
+//                             FAILED <job>
+//   CANCEL <job>           -> CANCELLING <job> | ERROR <motivo>
+//   JOBS                   -> JOB <job> <id> queued|running ..., e END
+//   SHUTDOWN               -> BYE (cancela os jobs e encerra)
+// Os jobs de um cliente que desconecta sao cancelados.
+class Daemon {
+public:
+    Daemon();
+
+    int run(const char *path, int workers);
+
+private:
+    int server;
+    int workers;
+    int nextJob;
+    bool finished;
+    map< string, DaemonInstance > instances;
+    map< int, string > buffers;     // entrada pendente de cada cliente
+    deque< DaemonJob > queued;
+    vector< DaemonJob > running;
+
+    void acceptClient();
+    bool readClient(int client);
+    void closeClient(int client);
+    void command(int client, const string &line);
+
+    void load(int client, vector< string > &words);
+    void solve(int client, vector< string > &words);
+    void cancel(int client, vector< string > &words);
+    void listJobs(int client);
+
+    void startJobs();
+    void reapJobs();
+    void runJob(DaemonJob &job);
+};
+
+int runDaemon(int argc, char **argv);
+
+#endif
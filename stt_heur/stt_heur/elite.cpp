@@ -0,0 +1,214 @@
+#include <cstdlib>
+#include <climits>
+#include <random>
+#include <utility>
+#include "elite.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+
+static uint64_t mixShape(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+
+// Forma da solucao: o evento e a duracao de cada meet e o meet de cada task.
+// Muda quando meets sao divididos ou juntados.
+uint64_t solnShape(KHE_SOLN soln) {
+    uint64_t hash = mixShape(KheSolnMeetCount(soln), KheSolnTaskCount(soln));
+    for (int i = 0; i < KheSolnMeetCount(soln); i++) {
+        KHE_MEET meet = KheSolnMeet(soln, i);
+        KHE_EVENT event = KheMeetEvent(meet);
+        hash = mixShape(hash, event == NULL ? 0 : KheEventIndex(event) + 1);
+        hash = mixShape(hash, KheMeetDuration(meet));
+    }
+    for (int i = 0; i < KheSolnTaskCount(soln); i++) {
+        KHE_MEET meet = KheTaskMeet(KheSolnTask(soln, i));
+        hash = mixShape(hash, meet == NULL ? 0 : KheMeetIndex(meet) + 1);
+    }
+    return hash;
+}
+
+void captureSoln(KHE_SOLN soln, EliteSolution &elite) {
+    elite.cost = KheSolnCost(soln);
+    elite.shape = solnShape(soln);
+    elite.times.resize(KheSolnMeetCount(soln));
+    for (int i = 0; i < KheSolnMeetCount(soln); i++) {
+        KHE_MEET meet = KheSolnMeet(soln, i);
+        KHE_TIME time = KheMeetIsCycleMeet(meet) ? NULL : KheMeetAsstTime(meet);
+        elite.times[i] = time == NULL ? -1 : KheTimeIndex(time);
+    }
+    elite.resources.resize(KheSolnTaskCount(soln));
+    for (int i = 0; i < KheSolnTaskCount(soln); i++) {
+        KHE_TASK task = KheSolnTask(soln, i);
+        KHE_RESOURCE resource = KheTaskIsCycle(task) ? NULL : KheTaskAsstResource(task);
+        elite.resources[i] = resource == NULL ? -1 : KheResourceIndexInInstance(resource);
+    }
+}
+
+// Nro de meets e tasks com atribuicao diferente (INT_MAX entre formas
+// diferentes)
+int eliteDistance(EliteSolution &a, EliteSolution &b) {
+    if (a.shape != b.shape) return INT_MAX;
+    int distance = 0;
+    for (int i = 0; i < a.times.size(); i++)
+        distance += a.times[i] != b.times[i];
+    for (int i = 0; i < a.resources.size(); i++)
+        distance += a.resources[i] != b.resources[i];
+    return distance;
+}
+
+// Atributo: meet i (i < nro de meets) ou task i - nro de meets. Leva o
+// atributo da solucao ao valor que ele tem em elite; falso se nao mudou.
+bool applyEliteAttribute(KHE_SOLN soln, KHE_INSTANCE instance, EliteSolution &elite, int attribute) {
+    int meets = elite.times.size();
+    if (attribute < meets) {
+        if (elite.times[attribute] < 0) return false;
+        return KheMeetMoveTime(KheSolnMeet(soln, attribute), KheInstanceTime(instance, elite.times[attribute]));
+    }
+    KHE_TASK task = KheSolnTask(soln, attribute - meets);
+    int resource = elite.resources[attribute - meets];
+    if (resource < 0) {
+        if (KheTaskAsst(task) == NULL) return false;
+        KheTaskUnAssign(task);
+        return true;
+    }
+    return KheTaskMoveResource(task, KheInstanceResource(instance, resource));
+}
+
+// Leva a solucao, que precisa ter a forma de elite, as atribuicoes de elite
+void applyElite(KHE_SOLN soln, KHE_INSTANCE instance, EliteSolution &elite) {
+    EliteSolution current;
+    captureSoln(soln, current);
+    int meets = elite.times.size();
+    for (int i = 0; i < meets; i++)
+        if (current.times[i] != elite.times[i])
+            applyEliteAttribute(soln, instance, elite, i);
+    for (int i = 0; i < elite.resources.size(); i++)
+        if (current.resources[i] != elite.resources[i])
+            applyEliteAttribute(soln, instance, elite, meets + i);
+}
+
+// Path relinking: caminha da solucao ate guide, uma atribuicao por passo.
+// Em cada passo ate `candidates` das atribuicoes que ainda diferem, sorteadas
+// sem reposicao, sao avaliadas (com transacao, desfeita) e a de menor custo e
+// aplicada; as que nao podem ser aplicadas saem do caminho. O melhor intermediario (sem as
+// pontas) vai para best; falso se o caminho nao teve intermediarios.
+bool relinkPath(KHE_SOLN soln, KHE_INSTANCE instance, EliteSolution &guide, int candidates,
+                unsigned seed, Config &config, EliteSolution &best) {
+    EliteSolution current;
+    captureSoln(soln, current);
+    if (current.shape != guide.shape) return false;
+
+    vector< int > differing;
+    int meets = guide.times.size();
+    for (int i = 0; i < meets; i++)
+        if (guide.times[i] >= 0 && current.times[i] != guide.times[i])
+            differing.push_back(i);
+    for (int i = 0; i < guide.resources.size(); i++)
+        if (current.resources[i] != guide.resources[i])
+            differing.push_back(meets + i);
+
+    mt19937 random(seed);
+    bool found = false;
+    while (differing.size() > 1 && config.getRemainingTime() > 0) {
+        int chosen = -1;
+        KHE_COST chosenCost = 0;
+        vector< char > removed(differing.size(), false);
+        // amostra sem reposicao: Fisher-Yates parcial nas primeiras posicoes
+        for (int c = 0; c < candidates && c < differing.size(); c++) {
+            swap(differing[c], differing[c + random() % (differing.size() - c)]);
+            KHE_TRANSACTION t = KheTransactionMake(soln);
+            KheTransactionBegin(t);
+            bool applied = applyEliteAttribute(soln, instance, guide, differing[c]);
+            KheTransactionEnd(t);
+            KHE_COST cost = KheSolnCost(soln);
+            KheTransactionUndo(t);
+            KheTransactionDelete(t);
+            if (!applied)
+                removed[c] = true;
+            else if (chosen < 0 || cost < chosenCost) {
+                chosen = c;
+                chosenCost = cost;
+            }
+        }
+        if (chosen >= 0) {
+            applyEliteAttribute(soln, instance, guide, differing[chosen]);
+            removed[chosen] = true;
+        }
+        int kept = 0;
+        for (int i = 0; i < differing.size(); i++)
+            if (!removed[i])
+                differing[kept++] = differing[i];
+        differing.resize(kept);
+
+        if (chosen >= 0 && !differing.empty() && (!found || KheSolnCost(soln) < best.cost)) {
+            captureSoln(soln, best);
+            found = true;
+        }
+    }
+    return found;
+}
+
+//--------------------------------------------------------------------------
+
+ElitePool::ElitePool() {
+    this->capacity = 0;
+    this->minDistance = 0;
+}
+
+void ElitePool::configure(int capacity, int minDistance) {
+    this->elites.clear();
+    this->capacity = capacity;
+    this->minDistance = minDistance;
+}
+
+void ElitePool::clear() {
+    this->elites.clear();
+}
+
+bool ElitePool::add(KHE_SOLN soln) {
+    if (this->capacity <= 0) return false;
+    EliteSolution elite;
+    captureSoln(soln, elite);
+    return this->add(elite);
+}
+
+bool ElitePool::add(EliteSolution &elite) {
+    if (this->capacity <= 0) return false;
+
+    int closest = -1, closestDistance = INT_MAX, worst = -1;
+    for (int i = 0; i < this->elites.size(); i++) {
+        int distance = eliteDistance(elite, this->elites[i]);
+        if (distance == 0) return false;
+        if (distance < closestDistance) {
+            closest = i;
+            closestDistance = distance;
+        }
+        if (worst < 0 || this->elites[worst].cost < this->elites[i].cost)
+            worst = i;
+    }
+
+    // perto demais de uma solucao do pool: so a substitui, se for melhor
+    if (closest >= 0 && closestDistance < this->minDistance) {
+        if (!(elite.cost < this->elites[closest].cost)) return false;
+        this->elites[closest] = elite;
+        return true;
+    }
+    if (this->elites.size() < this->capacity) {
+        this->elites.push_back(elite);
+        return true;
+    }
+    if (!(elite.cost < this->elites[worst].cost)) return false;
+    this->elites[worst] = elite;
+    return true;
+}
+
+int ElitePool::size() {
+    return this->elites.size();
+}
+
+EliteSolution &ElitePool::solution(int i) {
+    return this->elites[i];
+}
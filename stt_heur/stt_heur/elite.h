@@ -0,0 +1,58 @@
+#ifndef elite_h
+#define elite_h
+
+#include <vector>
+#include <cstdint>
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+#include "config.h"
+
+using namespace std;
+
+// Atribuicoes de uma solucao em vetores compactos: o horario de cada meet e
+// o recurso de cada task, pelos indices na solucao (-1: sem atribuicao, ou
+// meet/task de ciclo). So solucoes com a mesma forma (mesmos meets e tasks,
+// ver solnShape) sao comparaveis.
+class EliteSolution {
+public:
+    KHE_COST cost;
+    uint64_t shape;
+    vector< int > times;
+    vector< int > resources;
+};
+
+uint64_t solnShape(KHE_SOLN soln);
+void captureSoln(KHE_SOLN soln, EliteSolution &elite);
+int eliteDistance(EliteSolution &a, EliteSolution &b);
+bool applyEliteAttribute(KHE_SOLN soln, KHE_INSTANCE instance, EliteSolution &elite, int attribute);
+void applyElite(KHE_SOLN soln, KHE_INSTANCE instance, EliteSolution &elite);
+bool relinkPath(KHE_SOLN soln, KHE_INSTANCE instance, EliteSolution &guide, int candidates,
+                unsigned seed, Config &config, EliteSolution &best);
+
+// Pool das melhores solucoes distintas encontradas, com controle de
+// diversidade pela distancia entre atribuicoes (nro de meets e tasks com
+// atribuicao diferente). Uma solucao entra se nao repete nenhuma do pool e,
+// com o pool cheio, se e melhor que a pior; se estiver a menos de
+// minDistance da mais proxima, so entra no lugar dela, e se for melhor.
+class ElitePool {
+public:
+    ElitePool();
+
+    void configure(int capacity, int minDistance);
+    void clear();
+    bool add(KHE_SOLN soln);
+    bool add(EliteSolution &elite);
+
+    int size();
+    EliteSolution &solution(int i);
+
+private:
+    vector< EliteSolution > elites;
+    int capacity;
+    int minDistance;
+};
+
+#endif
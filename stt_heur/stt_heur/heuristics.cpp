@@ -6,7 +6,10 @@
 #include <vector>
 #include <iostream>
 #include <list>
+#include <set>
 #include <algorithm>
+#include <chrono>
+#include <random>
 
 extern "C" {
 #include "khe/khe.h"
@@ -15,16 +18,36 @@ extern "C" {
 
 #include "heuristics.h"
 #include "moves.h"
+#include "bounds.h"
+#include "telemetry.h"
+#include "replicas.h"
+#include "elite.h"
 
 MoveSwap swapMeet;
 MoveSwap swapMeetBlock;
 MoveSwap swapTask;
-MoveRealloc reallocMeetTime;
-MoveRealloc reallocTaskResource;
+MoveTargets reallocMeetTime;
+MoveTargets reallocTaskResource;
 MoveRealloc reallocPermutResource;
 MoveSwap swapKempeTimes;
-Move *moves[8];
-int neighbors[8];
+MoveSwap swapTimeSlot;
+ReplicaPool kempePool;
+vector< int > mergeEvents;
+vector< char > mergeFlags;
+int mergeMeetCount = -1;
+bool splitMoves = false;
+bool annealingCalibrated = false;
+ReplicaPool swapPool;
+ReplicaPool twoColourPool;
+ReplicaPool relinkPool;
+ElitePool elitePool;
+Move *moves[MAX_NEIGHBOR + 1];
+int neighbors[MAX_NEIGHBOR + 1];
+
+// rascunho de getMeetTarget, reusado entre os sorteios (um por thread)
+thread_local vector< KHE_TIMETABLE_MONITOR > targetTimetables;
+thread_local vector< int > targetTimes;
+thread_local vector< char > targetFree;
 
 //=====================================================
 // Configuracao dos Movimentos
@@ -32,12 +55,17 @@ int neighbors[8];
 
 void configureMoves(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
     config.assignResourcesConst = false;
+    splitMoves = false;
     for (int i = 0; (i < KheInstanceConstraintCount(instance)); ++i) {
         KHE_CONSTRAINT constraint = KheInstanceConstraint(instance, i);
         switch (KheConstraintTag(constraint)) {
             case KHE_ASSIGN_RESOURCE_CONSTRAINT_TAG:
                 config.assignResourcesConst = true;
                 break;
+            case KHE_SPLIT_EVENTS_CONSTRAINT_TAG:
+            case KHE_DISTRIBUTE_SPLIT_EVENTS_CONSTRAINT_TAG:
+                splitMoves = true;
+                break;
             default:
                 break;
         }
@@ -50,10 +78,11 @@ void configureMoves(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
         neighbors[MEET_BLOCK_SWAP] = 6000; // MEET_BLOCK_SWAP
         neighbors[MEET_TIME_CHANGE] = 9800; // MEET_TIME_CHANGE
         neighbors[PERMUT_RESOURCES] = 0; // PERMUT_RESOURCES
-        neighbors[KEMPE_TIMES] = 10000; // KEMPE_TIMES
-        //        neighbors[MEET_SPLIT] = 100000; // MEET_SPLIT
-        //        neighbors[MEET_MERGE] = 100000; // MEET_MERGE
-        //        neighbors[MEET_UNASSIGN] = 120000; // MEET_MERGE
+        neighbors[KEMPE_TIMES] = 9900; // KEMPE_TIMES
+        neighbors[TIME_SLOT_SWAP] = 9950; // TIME_SLOT_SWAP
+        neighbors[MEET_SPLIT] = 9950; // MEET_SPLIT
+        neighbors[MEET_MERGE] = 9950; // MEET_MERGE
+        neighbors[TWO_COLOUR_REASSIGN] = 10000; // TWO_COLOUR_REASSIGN
     } else {
         neighbors[MEET_SWAP] = 4000; // MEET_SWAP
         neighbors[TASK_SWAP] = 0; // TASK_SWAP
@@ -61,21 +90,54 @@ void configureMoves(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
         neighbors[MEET_BLOCK_SWAP] = 6000; // MEET_BLOCK_SWAP
         neighbors[MEET_TIME_CHANGE] = 9800; // MEET_TIME_CHANGE
         neighbors[PERMUT_RESOURCES] = 0; // PERMUT_RESOURCES
-        neighbors[KEMPE_TIMES] = 10000; // KEMPE_TIMES
-        //        neighbors[MEET_SPLIT] = 100000; // MEET_SPLIT
-        //        neighbors[MEET_MERGE] = 100000; // MEET_MERGE
-        //       neighbors[MEET_UNASSIGN] = 12000; // MEET_MERGE
+        neighbors[KEMPE_TIMES] = 9950; // KEMPE_TIMES
+        neighbors[TIME_SLOT_SWAP] = 10000; // TIME_SLOT_SWAP
+        neighbors[MEET_SPLIT] = 10000; // MEET_SPLIT
+        neighbors[MEET_MERGE] = 10000; // MEET_MERGE
+        neighbors[TWO_COLOUR_REASSIGN] = 10000; // TWO_COLOUR_REASSIGN
+    }
+
+    // divisao e juncao so quando a instancia restringe como os eventos
+    // sao divididos; ficam com 0,2% que eram das trocas de slots
+    if (splitMoves) {
+        neighbors[TIME_SLOT_SWAP] -= 20; // TIME_SLOT_SWAP
+        neighbors[MEET_SPLIT] -= 10; // MEET_SPLIT
+    }
+
+    // pesos dados nas opcoes (-nb_<vizinhanca>) substituem os padroes; os
+    // limites acumulados sao refeitos sobre 10000
+    bool weighted = false;
+    for (int i = 1; i <= MAX_NEIGHBOR; i++)
+        weighted = weighted || config.neighborWeights[i] >= 0;
+    if (weighted) {
+        int weights[MAX_NEIGHBOR + 1], total = 0, reached = 0;
+        for (int i = 1; i <= MAX_NEIGHBOR; i++) {
+            weights[i] = max(0, neighbors[i] - reached);
+            reached = max(reached, neighbors[i]);
+            if (config.neighborWeights[i] >= 0)
+                weights[i] = config.neighborWeights[i];
+            total += weights[i];
+        }
+        for (int i = 1, sum = 0; i <= MAX_NEIGHBOR; i++) {
+            sum += weights[i];
+            neighbors[i] = weights[i] == 0 ? -1 : (int) (sum * 10000LL / max(1, total));
+        }
     }
 
     swapMeet.configure(KheSolnMeetCount(soln));
     swapMeetBlock.configure(KheSolnMeetCount(soln));
     swapTask.configure(KheSolnTaskCount(soln));
 
-    reallocMeetTime.configure(KheSolnMeetCount(soln), KheInstanceTimeCount(instance));
-    reallocTaskResource.configure(KheSolnTaskCount(soln), KheInstanceResourceCount(instance));
+    reallocMeetTime.configure(0);
+    reallocTaskResource.configure(0);
+    syncMeetTargets(soln, instance);
+    syncTaskTargets(soln, instance);
+    mergeMeetCount = -1;
+    syncMergeEvents(soln, instance);
 
     swapKempeTimes.configure(KheInstanceTimeCount(instance));
     reallocPermutResource.configure(KheInstanceResourceCount(instance), 1);
+    swapTimeSlot.configure(KheInstanceTimeCount(instance));
 
     moves[MEET_SWAP] = (Move*) & swapMeet;
     moves[MEET_BLOCK_SWAP] = (Move*) & swapMeetBlock;
@@ -84,6 +146,45 @@ void configureMoves(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
     moves[TASK_RESOURCE_SWAP] = (Move*) & reallocTaskResource;
     moves[PERMUT_RESOURCES] = (Move*) & reallocPermutResource;
     moves[KEMPE_TIMES] = (Move*) & swapKempeTimes;
+    moves[TIME_SLOT_SWAP] = (Move*) & swapTimeSlot;
+
+    // os horarios ocupados dos recursos vem das timetables, que so sao
+    // mantidas enquanto ligadas; so as mudancas de horario (que a busca tabu
+    // sorteia sempre) e as cadeias de Kempe as consultam
+    bool timetables = config.tabu || (!config.lns &&
+            (neighborhoodEnabled(MEET_TIME_CHANGE) || neighborhoodEnabled(KEMPE_TIMES)));
+    for (int i = 0; i < KheInstanceResourceCount(instance) && timetables; i++) {
+        KHE_MONITOR tm = (KHE_MONITOR) KheResourceTimetableMonitor(soln, KheInstanceResource(instance, i));
+        if (!KheMonitorAttachedToSoln(tm))
+            KheMonitorAttachToSoln(tm);
+    }
+
+    if (config.kempeThreads > 1)
+        kempePool.configure(soln, config.kempeThreads);
+    if (config.bestDescent && config.threads > 1)
+        swapPool.configure(soln, config.threads);
+    if (config.assignResourcesConst && config.threads > 1)
+        twoColourPool.configure(soln, config.threads);
+    elitePool.configure(config.elite, config.eliteDistance);
+    if (config.elite > 0)
+        relinkPool.configure(soln, max(1, config.threads));
+}
+
+// Copias das pools que o align deixou desatualizadas (um meet dividido ou
+// juntado dentro de uma transacao): recopiadas entre dois movimentos
+void refreshReplicas(KHE_SOLN soln) {
+    kempePool.refresh(soln);
+    swapPool.refresh(soln);
+    twoColourPool.refresh(soln);
+    relinkPool.refresh(soln);
+}
+
+void releaseMoves() {
+    kempePool.clear();
+    swapPool.clear();
+    twoColourPool.clear();
+    relinkPool.clear();
+    elitePool.clear();
 }
 
 void restartMoves() {
@@ -94,6 +195,15 @@ void restartMoves() {
     reallocTaskResource.restart();
     swapKempeTimes.restart();
     reallocPermutResource.restart();
+    swapTimeSlot.restart();
+}
+
+// Verdadeiro se a vizinhanca tem alguma chance no sorteio
+bool neighborhoodEnabled(int neighborhood) {
+    int reached = -1;
+    for (int i = 1; i < neighborhood; i++)
+        reached = max(reached, neighbors[i]);
+    return neighbors[neighborhood] > reached;
 }
 
 int randomNeighborhood() {
@@ -105,6 +215,236 @@ int randomNeighborhood() {
     return 0;
 }
 
+//=====================================================
+// Destinos Legais
+//=====================================================
+
+// Horarios para onde o meet pode ir: os do seu dominio em que ele cabe no
+// cycle meet (meets fixos ficam sem destinos)
+void meetTimeTargets(KHE_SOLN soln, KHE_INSTANCE instance, KHE_MEET meet, vector< int > &times) {
+    times.clear();
+    if (KheMeetIsCycleMeet(meet)) return;
+
+    KHE_TIME_GROUP domain = KheMeetDomain(meet);
+    if (domain == NULL)
+        domain = KheInstanceFullTimeGroup(instance);
+    for (int i = 0; i < KheTimeGroupTimeCount(domain); i++) {
+        KHE_TIME time = KheTimeGroupTime(domain, i);
+        if (canMoveSlotMeet(soln, meet, time))
+            times.push_back(KheTimeIndex(time));
+    }
+}
+
+// Recursos para onde a task pode ir: os do seu dominio (tasks de cycle e
+// tasks pre-atribuidas ficam sem destinos)
+void taskResourceTargets(KHE_SOLN soln, KHE_INSTANCE instance, KHE_TASK task, vector< int > &resources) {
+    KHE_RESOURCE preassigned;
+    resources.clear();
+    if (KheTaskIsCycle(task) || KheTaskIsPreassigned(task, false, &preassigned)) return;
+
+    KHE_RESOURCE_GROUP domain = KheTaskDomain(task);
+    for (int i = 0; i < KheResourceGroupResourceCount(domain); i++)
+        resources.push_back(KheResourceIndexInInstance(KheResourceGroupResource(domain, i)));
+}
+
+// Acompanha meets criados ou removidos (divisao e juncao)
+void syncMeetTargets(KHE_SOLN soln, KHE_INSTANCE instance) {
+    int first = reallocMeetTime.targets.size();
+    if (first == KheSolnMeetCount(soln)) return;
+
+    vector< int > times;
+    reallocMeetTime.resize(KheSolnMeetCount(soln));
+    for (int i = first; i < KheSolnMeetCount(soln); i++) {
+        KHE_MEET meet = KheSolnMeet(soln, i);
+        meetTimeTargets(soln, instance, meet, times);
+        reallocMeetTime.setTargets(i, KheMeetDomain(meet), KheMeetDuration(meet), times);
+    }
+}
+
+void syncTaskTargets(KHE_SOLN soln, KHE_INSTANCE instance) {
+    int first = reallocTaskResource.targets.size();
+    if (first == KheSolnTaskCount(soln)) return;
+
+    vector< int > resources;
+    reallocTaskResource.resize(KheSolnTaskCount(soln));
+    for (int i = first; i < KheSolnTaskCount(soln); i++) {
+        KHE_TASK task = KheSolnTask(soln, i);
+        taskResourceTargets(soln, instance, task, resources);
+        reallocTaskResource.setTargets(i, KheTaskDomain(task), 0, resources);
+    }
+}
+
+// Sorteia (meet, horario) entre os destinos legais, ou (-1, -1) se nao ha
+// nenhum. O meet sorteado cujo dominio ou duracao mudou tem a entrada
+// refeita antes de ser usado.
+pair< int, int > getMeetTimeMove(KHE_SOLN soln, KHE_INSTANCE instance) {
+    vector< int > times;
+    syncMeetTargets(soln, instance);
+    while (reallocMeetTime.hasMove()) {
+        int i = reallocMeetTime.getSource();
+        KHE_MEET meet = KheSolnMeet(soln, i);
+        if (reallocMeetTime.isCurrent(i, KheMeetDomain(meet), KheMeetDuration(meet)))
+            return pair< int, int >(i, getMeetTarget(soln, meet, i));
+
+        meetTimeTargets(soln, instance, meet, times);
+        reallocMeetTime.setTargets(i, KheMeetDomain(meet), KheMeetDuration(meet), times);
+    }
+    return pair< int, int >(-1, -1);
+}
+
+// Sorteia um destino do meet i, preferindo os horarios em que os recursos
+// do meet estao livres, pelos horarios ocupados das timetables (sem avaliar
+// monitores). Destinos que sobrepoem o horario atual do meet contam como
+// livres, ja que ele mesmo ocupa os seus recursos ali. Apos
+// MEET_TARGET_DRAWS sorteios fica o ultimo, e a vizinhanca continua inteira.
+int getMeetTarget(KHE_SOLN soln, KHE_MEET meet, int i) {
+    int target = reallocMeetTime.getTarget(i);
+    vector< KHE_TIMETABLE_MONITOR > &timetables = targetTimetables;
+    timetables.clear();
+    for (int j = 0; j < KheMeetTaskCount(meet); j++) {
+        KHE_RESOURCE resource = KheTaskAsstResource(KheMeetTask(meet, j));
+        if (resource != NULL)
+            timetables.push_back(KheResourceTimetableMonitor(soln, resource));
+    }
+    if (timetables.empty()) return target;
+
+    int duration = KheMeetDuration(meet), current = KheMeetAssignedTimeIndex(meet);
+    vector< int > &times = targetTimes;
+    vector< char > &free = targetFree;
+    times.resize(KheInstanceTimeCount(KheSolnInstance(soln)));
+    free.assign(times.size(), false);
+    int count = KheTimetableMonitorsFreeTimes(timetables.data(), timetables.size(), duration, times.data());
+    for (int j = 0; j < count; j++)
+        free[times[j]] = true;
+    if (current != -1)
+        for (int t = max(0, current - duration + 1); t < current + duration && t < times.size(); t++)
+            free[t] = true;
+
+    for (int draw = 1; draw < MEET_TARGET_DRAWS && !free[target]; draw++)
+        target = reallocMeetTime.getTarget(i);
+    return target;
+}
+
+pair< int, int > getTaskResourceMove(KHE_SOLN soln, KHE_INSTANCE instance) {
+    vector< int > resources;
+    syncTaskTargets(soln, instance);
+    while (reallocTaskResource.hasMove()) {
+        int i = reallocTaskResource.getSource();
+        KHE_TASK task = KheSolnTask(soln, i);
+        if (reallocTaskResource.isCurrent(i, KheTaskDomain(task), 0))
+            return pair< int, int >(i, reallocTaskResource.getTarget(i));
+
+        taskResourceTargets(soln, instance, task, resources);
+        reallocTaskResource.setTargets(i, KheTaskDomain(task), 0, resources);
+    }
+    return pair< int, int >(-1, -1);
+}
+
+//=====================================================
+// Divisao e Juncao de Meets
+//=====================================================
+
+// Acompanha meets e tasks criados ou removidos nas trocas sorteadas
+void syncMeetSwaps(KHE_SOLN soln) {
+    if (swapMeet.sizeFirst != KheSolnMeetCount(soln)) {
+        swapMeet.configure(KheSolnMeetCount(soln));
+        swapMeetBlock.configure(KheSolnMeetCount(soln));
+    }
+    if (swapTask.sizeFirst != KheSolnTaskCount(soln))
+        swapTask.configure(KheSolnTaskCount(soln));
+}
+
+// Indice dos eventos com dois ou mais meets, os unicos com juncoes
+// possiveis. A divisao inclui o seu evento e as entradas que ficam com um
+// meet so saem quando sorteadas; se o numero de meets mudou por outro
+// caminho (desfazer, copia da solucao) o indice e refeito.
+void syncMergeEvents(KHE_SOLN soln, KHE_INSTANCE instance) {
+    if (mergeMeetCount == KheSolnMeetCount(soln)) return;
+
+    mergeEvents.clear();
+    mergeFlags.assign(KheInstanceEventCount(instance), 0);
+    for (int i = 0; i < KheInstanceEventCount(instance); i++) {
+        if (KheEventMeetCount(soln, KheInstanceEvent(instance, i)) >= 2) {
+            mergeEvents.push_back(i);
+            mergeFlags[i] = 1;
+        }
+    }
+    mergeMeetCount = KheSolnMeetCount(soln);
+}
+
+// Sorteia um meet que pode ser dividido, ou -1 se nao achar nenhum
+int getSplitMeet(KHE_SOLN soln) {
+    for (int numTries = 0; numTries < KheSolnMeetCount(soln); ++numTries) {
+        int meetIndex = rand() % KheSolnMeetCount(soln);
+        KHE_MEET meet = KheSolnMeet(soln, meetIndex);
+        if (KheMeetDuration(meet) > 1 && KheMeetEvent(meet) != NULL && !KheMeetIsCycleMeet(meet))
+            return meetIndex;
+    }
+    return -1;
+}
+
+// Sorteia dois meets de um mesmo evento, ou (-1, -1) se nao ha nenhum
+pair< int, int > getMergeMove(KHE_SOLN soln, KHE_INSTANCE instance) {
+    syncMergeEvents(soln, instance);
+    while (!mergeEvents.empty()) {
+        int p = rand() % mergeEvents.size();
+        KHE_EVENT event = KheInstanceEvent(instance, mergeEvents[p]);
+        int count = KheEventMeetCount(soln, event);
+        if (count >= 2) {
+            int a = rand() % count, b = rand() % (count - 1);
+            if (b >= a) b++;
+            return pair< int, int >(KheMeetIndex(KheEventMeet(soln, event, a)),
+                    KheMeetIndex(KheEventMeet(soln, event, b)));
+        }
+
+        mergeFlags[mergeEvents[p]] = 0;
+        mergeEvents[p] = mergeEvents.back();
+        mergeEvents.pop_back();
+    }
+    return pair< int, int >(-1, -1);
+}
+
+// Divide o meet num ponto sorteado
+bool splitMeet(KHE_SOLN soln, KHE_INSTANCE instance, KHE_MEET meet) {
+    KHE_MEET meet1, meet2;
+    syncMergeEvents(soln, instance);
+    if (!KheMeetSplit(meet, 1 + rand() % (KheMeetDuration(meet) - 1), false, &meet1, &meet2))
+        return false;
+
+    int event = KheEventIndex(KheMeetEvent(meet1));
+    if (!mergeFlags[event]) {
+        mergeEvents.push_back(event);
+        mergeFlags[event] = 1;
+    }
+    mergeMeetCount = KheSolnMeetCount(soln);
+    return true;
+}
+
+// Junta dois meets de um mesmo evento; se eles nao sao adjacentes, o
+// segundo vai antes para logo depois (ou logo antes) do primeiro
+bool mergeMeets(KHE_SOLN soln, KHE_MEET meet1, KHE_MEET meet2) {
+    KHE_MEET target = KheMeetAsst(meet1), oldTarget = KheMeetAsst(meet2), merged;
+    int oldOffset = KheMeetAsstOffset(meet2);
+    if (target == NULL || oldTarget == NULL || KheMeetIsCycleMeet(meet1) || KheMeetIsCycleMeet(meet2))
+        return false;
+    if (KheMeetMerge(meet1, meet2, &merged)) {
+        mergeMeetCount = KheSolnMeetCount(soln);
+        return true;
+    }
+
+    int offset = KheMeetAsstOffset(meet1);
+    if (!KheMeetMove(meet2, target, offset + KheMeetDuration(meet1)) &&
+            !KheMeetMove(meet2, target, offset - KheMeetDuration(meet2)))
+        return false;
+    if (KheMeetMerge(meet1, meet2, &merged)) {
+        mergeMeetCount = KheSolnMeetCount(soln);
+        return true;
+    }
+
+    KheMeetMove(meet2, oldTarget, oldOffset);
+    return false;
+}
+
 //=====================================================
 // Gerador de Vizinhos
 //=====================================================
@@ -112,7 +452,7 @@ int randomNeighborhood() {
 bool generateNeighbor(KHE_SOLN soln, KHE_INSTANCE instance, int &neighborhood) {
     if (neighborhood == 0)
         neighborhood = randomNeighborhood();
-
+    syncMeetSwaps(soln);
 
     pair< int, int > move;
 
@@ -126,8 +466,8 @@ bool generateNeighbor(KHE_SOLN soln, KHE_INSTANCE instance, int &neighborhood) {
             KheTaskSwap(KheSolnTask(soln, move.first), KheSolnTask(soln, move.second));
         return true;
     } else if (neighborhood == TASK_RESOURCE_SWAP && reallocTaskResource.hasMove()) {
-        move = reallocTaskResource.getMove();
-        if (!KheTaskIsCycle(KheSolnTask(soln, move.first)))
+        move = getTaskResourceMove(soln, instance);
+        if (move.first >= 0)
             KheTaskMoveResource(KheSolnTask(soln, move.first), KheInstanceResource(instance, move.second));
         return true;
     } else if (neighborhood == MEET_BLOCK_SWAP && swapMeetBlock.hasMove()) {
@@ -135,8 +475,9 @@ bool generateNeighbor(KHE_SOLN soln, KHE_INSTANCE instance, int &neighborhood) {
         KheMeetBlockSwap(KheSolnMeet(soln, move.first), KheSolnMeet(soln, move.second));
         return true;
     } else if (neighborhood == MEET_TIME_CHANGE && reallocMeetTime.hasMove()) {
-        move = reallocMeetTime.getMove();
-        KheMeetMoveTime(KheSolnMeet(soln, move.first), KheInstanceTime(instance, move.second));
+        move = getMeetTimeMove(soln, instance);
+        if (move.first >= 0)
+            KheMeetMoveTime(KheSolnMeet(soln, move.first), KheInstanceTime(instance, move.second));
         return true;
     } else if (neighborhood == PERMUT_RESOURCES && reallocPermutResource.hasMove()) {
         //move = reallocPermutResource.getMove();
@@ -155,83 +496,23 @@ bool generateNeighbor(KHE_SOLN soln, KHE_INSTANCE instance, int &neighborhood) {
             newTime = (newTime == move.first) ? move.second : move.first;
         }
         return true;
+    } else if (neighborhood == TIME_SLOT_SWAP && swapTimeSlot.hasMove()) {
+        move = swapTimeSlot.getMove();
+        return swapTimeSlots(soln, KheInstanceTime(instance, move.first), KheInstanceTime(instance, move.second));
     } else if (neighborhood == MEET_SPLIT) { //Meet duration split
-        //        KHE_COST originalCost = KheSolnCost(soln);
-        //printf("Original %f\n", KheCostShow(KheSolnCost(soln)));
-        //        for(int i = 0; i < KheSolnMeetCount(soln); ++i) {
-        //            if(KheMeetEvent(KheSolnMeet(soln, i)) != NULL)
-        //                printf("%d %s %d %s\n", i, KheEventId(KheMeetEvent(KheSolnMeet(soln, i))), KheMeetDuration(KheSolnMeet(soln, i)), KheTimeId(KheMeetAsstTime(KheSolnMeet(soln, i))));
-        //        }
-        int duration = 0;
-        int meetIndex;
-        int numTries = 0;
-        do {
-            meetIndex = rand() % KheSolnMeetCount(soln);
-            duration = KheMeetDuration(KheSolnMeet(soln, meetIndex));
-            ++numTries;
-            if (numTries > KheSolnMeetCount(soln))
-                return false;
-        } while (duration == 1);
-        //Cria um novo meet de duração 1
-        KHE_MEET meet1, meet2;
-        //int index1, index2;
-        //KheSolnAddMeet(soln, meet1, &index1);
-        //KheSolnAddMeet(soln, meet2, &index2);
-        KheMeetSplit(KheSolnMeet(soln, meetIndex), 1, false, &meet1, &meet2);
-
-
-        //printf("Selected meet: %d\n", meetIndex);
-        //        for(int i = 0; i < KheSolnMeetCount(soln); ++i) {
-        //            if(KheMeetEvent(KheSolnMeet(soln, i)) != NULL)
-        //                printf("%d %s %d %s\n", i, KheEventId(KheMeetEvent(KheSolnMeet(soln, i))), KheMeetDuration(KheSolnMeet(soln, i)), KheTimeId(KheMeetAsstTime(KheSolnMeet(soln, i))));
-        //        }
-        //printf("Changed %f\n", KheCostShow(KheSolnCost(soln)));
-        //        if(isBetterSolution(KheCostShow(KheSolnCost(soln)), originalCost));
-        //            printf("Improved %f %f\n", KheCostShow(originalCost), KheCostShow(KheSolnCost(soln)));
+        int meetIndex = getSplitMeet(soln);
+        if (meetIndex < 0)
+            return false;
+        splitMeet(soln, instance, KheSolnMeet(soln, meetIndex));
         return true;
     } else if (neighborhood == MEET_MERGE) { //Meet duration merge
-        printf("Original %f\n", KheCostShow(KheSolnCost(soln)));
-        for (int i = 0; i < KheSolnMeetCount(soln); ++i) {
-            if (KheMeetAsstTime(KheSolnMeet(soln, i)) != NULL && KheMeetEvent(KheSolnMeet(soln, i)) != NULL) {
-                for (int j = i + 1; j < KheSolnMeetCount(soln); ++j) {
-                    if (KheMeetAsstTime(KheSolnMeet(soln, j)) != NULL && KheMeetEvent(KheSolnMeet(soln, j)) != NULL) {
-                        //Merges the first possible merge
-                        KHE_MEET merged;
-                        if (KheMeetMerge(KheSolnMeet(soln, i), KheSolnMeet(soln, j), &merged)) {
-                            //KHE error: KheTransactionUndo prevented by unsuitable operations
-                            printf("Mergiu! kk\n");
-                            printf("Changed %f\n", KheCostShow(KheSolnCost(soln)));
-                            return true;
-                        }
-                    }
-                }
-            }
-        }
-    } else if (neighborhood == MEET_UNASSIGN) { //Meet unassign time
-
-
-
-        //        int index1 = rand() % KheInstanceResourceCount(instance);
-        //        int index2 = rand() % KheInstanceResourceCount(instance);
-        //        if(index1 != index2)
-        //        KheTwoColourReassign(soln, KheInstanceResource(instance, index1),
-        //              KheInstanceResource(instance, index2), true);
-
-
-        //KheEjectionChainRepairTimes(KheSolnNode(soln, 0));
-        printf("%f\n", KheCostShow(KheSolnCost(soln)));
-        //Unassign clashes..
-        //        printf("Original %f\n", KheCostShow(KheSolnCost(soln)));
-        //        
-        //        int meetIndex = -1;
-        //        do {
-        //            meetIndex = rand() % KheSolnMeetCount(soln);
-        //        } while(KheMeetAsstTime(KheSolnMeet(soln, meetIndex)) == NULL || 
-        //                KheMeetEvent(KheSolnMeet(soln, meetIndex)) == NULL);
-        //        //printf("%s\n", KheEventId(KheMeetEvent(KheSolnMeet(soln, meetIndex))));
-        //        KheMeetUnAssignTime(KheSolnMeet(soln, meetIndex));
-        //        printf("Changed %f\n", KheCostShow(KheSolnCost(soln)));
-        //printf("%s\n", KheEventId(KheMeetEvent(KheSolnMeet(soln, meetIndex))));
+        move = getMergeMove(soln, instance);
+        if (move.first < 0)
+            return false;
+        mergeMeets(soln, KheSolnMeet(soln, move.first), KheSolnMeet(soln, move.second));
+        return true;
+    } else if (neighborhood == TWO_COLOUR_REASSIGN) {
+        return twoColourReassign(soln, instance);
     }
     return false;
 }
@@ -265,34 +546,32 @@ list< int > bfsConflictsGraph(map< int, map< int, int > > &G, map< int, int > &v
 list< int > generateConflictsGraph(KHE_SOLN soln, KHE_INSTANCE instance, KHE_TIME time1, KHE_TIME time2) {
     map< int, map< int, int > > G;
     vector< int > meetsTime1;
-    vector< int > meetsTime2;
 
     KHE_MEET meet1, meet2;
-    KHE_TASK task1, task2;
+    KHE_TASK task1;
 
     for (int i = 0; i < KheSolnMeetCount(soln); ++i) {
         if (KheMeetAsstTime(KheSolnMeet(soln, i)) && KheTimeIndex(KheMeetAsstTime(KheSolnMeet(soln, i))) == KheTimeIndex(time1))
             meetsTime1.push_back(i);
-        if (KheMeetAsstTime(KheSolnMeet(soln, i)) && KheTimeIndex(KheMeetAsstTime(KheSolnMeet(soln, i))) == KheTimeIndex(time2))
-            meetsTime2.push_back(i);
     }
 
+    // um recurso de meet1 ocupado em time2 liga meet1 aos meets que comecam
+    // em time2 na timetable dele; recursos livres em time2 sao descartados
+    // pelos horarios ocupados, sem percorrer os meets de time2
     for (int m1 = 0; m1 < meetsTime1.size(); ++m1) {
         meet1 = KheSolnMeet(soln, meetsTime1[m1]);
-        for (int m2 = 0; m2 < meetsTime2.size(); ++m2) {
-            meet2 = KheSolnMeet(soln, meetsTime2[m2]);
-            for (int t1 = 0, t1Max = KheMeetTaskCount(meet1); t1 < t1Max; ++t1) {
-                task1 = KheMeetTask(meet1, t1);
-                if (!KheTaskAsstResource(task1)) continue;
-                for (int t2 = 0, t2Max = KheMeetTaskCount(meet2); t2 < t2Max; ++t2) {
-                    task2 = KheMeetTask(meet2, t2);
-                    if (!KheTaskAsstResource(task2)) continue;
-
-                    if (strcmp(KheResourceId(KheTaskAsstResource(task1)), KheResourceId(KheTaskAsstResource(task2))) == 0) {
-                        G[meetsTime1[m1]][meetsTime2[m2]] = 1;
-                        G[meetsTime2[m2]][meetsTime1[m1]] = 1;
-                    }
-                }
+        for (int t1 = 0, t1Max = KheMeetTaskCount(meet1); t1 < t1Max; ++t1) {
+            task1 = KheMeetTask(meet1, t1);
+            if (!KheTaskAsstResource(task1)) continue;
+            KHE_TIMETABLE_MONITOR tm = KheResourceTimetableMonitor(soln, KheTaskAsstResource(task1));
+            if (KheTimetableMonitorTimesAreFree(tm, time2, 1)) continue;
+
+            for (int m2 = 0; m2 < KheTimetableMonitorTimeMeetCount(tm, time2); ++m2) {
+                meet2 = KheTimetableMonitorTimeMeet(tm, time2, m2);
+                if (KheMeetAssignedTimeIndex(meet2) != KheTimeIndex(time2)) continue;
+
+                G[meetsTime1[m1]][KheMeetIndex(meet2)] = 1;
+                G[KheMeetIndex(meet2)][meetsTime1[m1]] = 1;
             }
         }
     }
@@ -304,26 +583,36 @@ list< int > generateConflictsGraph(KHE_SOLN soln, KHE_INSTANCE instance, KHE_TIM
     int currentSoftFitness = -1, neighborSoftFitness = -1, bestSoftFitness = KheSoftCost(KheSolnCost(soln));
     float delta;
 
-    bool first = true;
+    // uma cadeia candidata por meet inicial
+    vector< list< int > > chains;
     for (int i = 0; i < meetsTime1.size(); i++) {
         if (!G.count(meetsTime1[i])) continue;
 
         x.clear();
         conflicts = bfsConflictsGraph(G, x, meetsTime1[i], 0);
         if (conflicts.size() <= 2) continue;
+        chains.push_back(conflicts);
+    }
 
-        // realiza o movimento        
-        KHE_TRANSACTION t = KheTransactionMake(soln);
-        KheTransactionBegin(t);
-        KHE_TIME newTime = time2;
-        for (list< int >::iterator it = conflicts.begin(); it != conflicts.end(); it++) {
-            KheMeetMoveTime(KheSolnMeet(soln, *it), newTime);
-            newTime = (newTime == time1) ? time2 : time1;
-        }
-        KheTransactionEnd(t);
+    // as cadeias sao independentes: com copias da solucao, cada thread
+    // avalia uma parte delas
+    vector< KHE_COST > costs(chains.size());
+    if (kempePool.size() > 0 && chains.size() > 1 && kempePool.align(soln)) {
+        int workers = kempePool.size();
+        kempePool.run([&](int id, KHE_SOLN replica) {
+            for (int i = id; i < chains.size(); i += workers)
+                costs[i] = evaluateKempeChain(replica, chains[i], time1, time2);
+        });
+    } else {
+        for (int i = 0; i < chains.size(); i++)
+            costs[i] = evaluateKempeChain(soln, chains[i], time1, time2);
+    }
 
-        neighborHardFitness = KheHardCost(KheSolnCost(soln));
-        neighborSoftFitness = KheSoftCost(KheSolnCost(soln));
+    bool first = true;
+    for (int i = 0; i < chains.size(); i++) {
+        conflicts = chains[i];
+        neighborHardFitness = KheHardCost(costs[i]);
+        neighborSoftFitness = KheSoftCost(costs[i]);
 
         // valida o movimento: se for melhor, vai para bestConflicts
         if (first) {
@@ -349,20 +638,88 @@ list< int > generateConflictsGraph(KHE_SOLN soln, KHE_INSTANCE instance, KHE_TIM
             currentHardFitness = neighborHardFitness;
             currentSoftFitness = neighborSoftFitness;
         }
-
-        KheTransactionUndo(t);
-        KheTransactionDelete(t);
-
-        //        cout << "Conexoes '" << i << "': ";
-        //        for (list< int >::iterator it = c[i].begin(); it != c[i].end(); ++it)
-        //            cout << *it << " ( " << KheTimeIndex(KheMeetAsstTime(KheSolnMeet(soln, *it))) << " ) " << " -> ";
-        //        cout << endl;    
     }
     //printf("Best Kemp: Hard = %d, Soft = %d  [cadeia de %d meets]\n", currentHardFitness, currentSoftFitness, bestConflicts.size());
 
     return bestConflicts;
 }
 
+// Custo da solucao com a cadeia aplicada; a solucao volta ao estado original
+KHE_COST evaluateKempeChain(KHE_SOLN soln, list< int > &chain, KHE_TIME time1, KHE_TIME time2) {
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    KheTransactionBegin(t);
+    KHE_TIME newTime = time2;
+    for (list< int >::iterator it = chain.begin(); it != chain.end(); it++) {
+        KheMeetMoveTime(KheSolnMeet(soln, *it), newTime);
+        newTime = (newTime == time1) ? time2 : time1;
+    }
+    KheTransactionEnd(t);
+
+    KHE_COST cost = KheSolnCost(soln);
+    KheTransactionUndo(t);
+    KheTransactionDelete(t);
+    return cost;
+}
+
+//=====================================================
+// Movimentos Slot
+//=====================================================
+
+bool canMoveSlotMeet(KHE_SOLN soln, KHE_MEET meet, KHE_TIME time) {
+    KHE_TIME preassignedTime;
+    if (KheMeetIsPreassigned(meet, true, &preassignedTime) || KheMeetIsPreassigned(meet, false, &preassignedTime))
+        return false;
+
+    if (KheMeetDomain(meet) != NULL && !KheTimeGroupContains(KheMeetDomain(meet), time))
+        return false;
+
+    // o meet precisa caber no cycle meet do novo horario
+    return KheSolnTimeCycleMeetOffset(soln, time) + KheMeetDuration(meet) <= KheMeetDuration(KheSolnTimeCycleMeet(soln, time));
+}
+
+bool collectSlotMeets(KHE_SOLN soln, KHE_TIME time, KHE_TIME newTime, vector< KHE_MEET > &meets) {
+    KHE_MEET cycleMeet = KheSolnTimeCycleMeet(soln, time);
+    int offset = KheSolnTimeCycleMeetOffset(soln, time);
+
+    for (int i = 0; i < KheMeetAssignedToCount(cycleMeet); ++i) {
+        KHE_MEET meet = KheMeetAssignedTo(cycleMeet, i);
+        if (KheMeetAsstOffset(meet) != offset) continue;
+
+        // um unico meet fixo ou fora do dominio bloqueia a troca inteira
+        if (!canMoveSlotMeet(soln, meet, newTime))
+            return false;
+        meets.push_back(meet);
+    }
+    return true;
+}
+
+bool swapTimeSlots(KHE_SOLN soln, KHE_TIME time1, KHE_TIME time2) {
+    vector< KHE_MEET > meetsTime1, meetsTime2;
+
+    // filtra os pares invalidos antes de alterar a solucao
+    if (!collectSlotMeets(soln, time1, time2, meetsTime1) || !collectSlotMeets(soln, time2, time1, meetsTime2))
+        return false;
+    if (meetsTime1.empty() && meetsTime2.empty())
+        return false;
+
+    // realiza a troca completa em uma unica transacao
+    bool success = true;
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    KheTransactionBegin(t);
+    for (int i = 0; success && i < meetsTime1.size(); ++i)
+        success = KheMeetMoveTime(meetsTime1[i], time2);
+    for (int i = 0; success && i < meetsTime2.size(); ++i)
+        success = KheMeetMoveTime(meetsTime2[i], time1);
+    KheTransactionEnd(t);
+
+    // desfaz a troca parcial caso algum meet nao possa ser movido
+    if (!success)
+        KheTransactionUndo(t);
+    KheTransactionDelete(t);
+
+    return success;
+}
+
 //=====================================================
 // Movimentos Permut
 //=====================================================
@@ -454,6 +811,58 @@ KHE_SOLN permutResource(KHE_SOLN soln, KHE_INSTANCE instance, KHE_RESOURCE resou
 // Metaheuristicas
 //=====================================================
 
+// Calibracao do SA: amostra movimentos aleatorios a partir de soln (todos
+// desfeitos) e escolhe as temperaturas em que uma piora media da parte soft
+// e aceita com probabilidade saAcceptIni (inicio do ciclo) e saAcceptEnd
+// (fim do ciclo). Enquanto houver menos de saMinWorse pioras soft, a amostra
+// cresce ate 10 * saSamples; se nem assim houver, a media nao e confiavel e
+// as temperaturas ficam como estao. Retorna se o SA deve usar temperaturas
+// calibradas.
+bool calibrateAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    double sum = 0;
+    int worse = 0, samples = 0;
+    restartMoves();
+    for (; (samples < config.saSamples || (worse < config.saMinWorse && samples < 10 * config.saSamples))
+            && config.getRemainingTime() > 0; samples++) {
+        int neighborhood = 0;
+        KHE_COST costBefore = KheSolnCost(soln);
+        KHE_TRANSACTION t = KheTransactionMake(soln);
+        KheTransactionBegin(t);
+        generateNeighbor(soln, instance, neighborhood);
+        KheTransactionEnd(t);
+        KHE_COST costAfter = KheSolnCost(soln);
+        KheTransactionUndo(t);
+        KheTransactionDelete(t);
+        if (KheHardCost(costAfter) == KheHardCost(costBefore) && KheSoftCost(costAfter) > KheSoftCost(costBefore)) {
+            sum += KheSoftCost(costAfter) - KheSoftCost(costBefore);
+            worse++;
+        }
+    }
+    restartMoves();
+    if (worse < config.saMinWorse) {
+        // as temperaturas de uma calibracao anterior continuam valendo; sem
+        // nenhuma, o SA volta a -sa_tempini/-sa_tempmin (delta normalizado)
+        printf("SA calibration: only %d of %d samples worsen just the soft cost, %s\n", worse, samples,
+               annealingCalibrated ? "keeping the previous temperatures" : "using -sa_tempini/-sa_tempmin");
+        return annealingCalibrated;
+    }
+    
+    double mean = sum / worse;
+    config.saTempIni = -mean / log(config.saAcceptIni);
+    config.saTempMin = -mean / log(config.saAcceptEnd);
+    annealingCalibrated = true;
+    printf("SA calibration: %d of %d samples worsen the soft cost by %.2f on average, temperature %.4f -> %.4f\n",
+           worse, samples, mean, config.saTempIni, config.saTempMin);
+    return true;
+}
+
+// Com saCalibrate, as temperaturas vem de calibrateAnnealing, o delta e a
+// diferenca de custo sem normalizar e o resfriamento se ajusta ao tempo
+// (se a calibracao tiver poucas amostras, vale o SA sem calibrar):
+// o SA fica com saTimeShare% do tempo restante, dividido igualmente entre os
+// ciclos (reaquecimentos), e ao fim de cada nivel o fator de resfriamento e
+// escolhido para que os niveis que ainda cabem no ciclo, na duracao do
+// ultimo, levem a temperatura ate saTempMin.
 KHE_SOLN simulatedAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
     KHE_SOLN bestSoln = soln;
     KHE_COST costAfter, costBefore;
@@ -461,18 +870,30 @@ KHE_SOLN simulatedAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config
     soln = KheSolnCopy(bestSoln);
 
     int neighborhood = 0;
-    int reheats = -1;
+    int reheats = config.state.saReheats;
     int iterTemp = 0;
-    double currentTemp = config.saTempIni;
     double delta, random;
 
-    while (reheats < config.saReheats && config.getRemainingTime() > 0) {
+    bool calibrated = config.saCalibrate && calibrateAnnealing(soln, instance, config);
+    chrono::steady_clock::time_point now, saEnd, cycleEnd, levelStart;
+    if (calibrated) {
+        now = levelStart = chrono::steady_clock::now();
+        saEnd = now + chrono::milliseconds(config.getRemainingTime() * 10L * config.saTimeShare);
+        cycleEnd = now + (saEnd - now) / max(1, config.saReheats - reheats);
+    }
+    double currentTemp = config.state.saTemp > 0 ? config.state.saTemp : config.saTempIni;
+    if (currentTemp > config.saTempIni || currentTemp < config.saTempMin)
+        currentTemp = config.saTempIni;
+
+    while (reheats < config.saReheats && config.getRemainingTime() > 0
+            && (!calibrated || chrono::steady_clock::now() < saEnd)) {
         restartMoves();
         while (iterTemp < config.saMax && config.getRemainingTime() > 0) {
             iterTemp++;
             neighborhood = 0;
 
             // Gerando vizinho
+            refreshReplicas(soln);
             costBefore = KheSolnCost(soln);
             t = KheTransactionMake(soln);
             KheTransactionBegin(t);
@@ -480,10 +901,14 @@ KHE_SOLN simulatedAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config
             KheTransactionEnd(t);
             costAfter = KheSolnCost(soln);
 
-            delta = (KheHardCost(costAfter) - KheHardCost(costBefore)) * 10000.0 + (KheSoftCost(costAfter) - KheSoftCost(costBefore))
-                    / (KheHardCost(KheSolnCost(bestSoln)) * 10000.0 + KheSoftCost(KheSolnCost(bestSoln)));
+            if (calibrated)
+                delta = (KheHardCost(costAfter) - KheHardCost(costBefore)) * 10000.0 + (KheSoftCost(costAfter) - KheSoftCost(costBefore));
+            else
+                delta = (KheHardCost(costAfter) - KheHardCost(costBefore)) * 10000.0 + (KheSoftCost(costAfter) - KheSoftCost(costBefore))
+                        / (KheHardCost(KheSolnCost(bestSoln)) * 10000.0 + KheSoftCost(KheSolnCost(bestSoln)));
             random = (1 + rand() % 100000) / 100000.0;
 
+            bool accepted = true;
             if (delta <= 0) {
                 if (isBetterSolution(soln, bestSoln)) {
                     KheSolnDelete(bestSoln);
@@ -496,21 +921,39 @@ KHE_SOLN simulatedAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config
                 restartMoves();
             } else {
                 KheTransactionUndo(t);
+                accepted = false;
             }
             KheTransactionDelete(t);
+            telemetry.iteration(soln, neighborhood, accepted);
         }
-        currentTemp = currentTemp * config.saAlpha;
         iterTemp = 0;
 
+        if (calibrated) {
+            now = chrono::steady_clock::now();
+            double levelTime = chrono::duration< double >(now - levelStart).count();
+            double cycleLeft = chrono::duration< double >(cycleEnd - now).count();
+            levelStart = now;
+            if (cycleLeft <= levelTime)
+                currentTemp = config.saTempMin;
+            else
+                currentTemp = currentTemp * pow(config.saTempMin / currentTemp, levelTime / cycleLeft);
+        } else
+            currentTemp = currentTemp * config.saAlpha;
+
         if (currentTemp <= config.saTempMin) {
             reheats++;
             currentTemp = config.saTempIni;
+            elitePool.add(soln);
             KheSolnDelete(soln);
             soln = KheSolnCopy(bestSoln);
             printf("Reaquecendo (time: %d)\n", config.getRunTime());
+            if (calibrated)
+                cycleEnd = now + (saEnd - now) / max(1, config.saReheats - reheats);
         }
     }
 
+    config.state.saTemp = currentTemp;
+    config.state.saReheats = reheats;
     KheSolnDelete(soln);
     return bestSoln;
 }
@@ -518,13 +961,19 @@ KHE_SOLN simulatedAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config
 KHE_SOLN ils(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
     soln = descent(soln, soln, instance, config.ilsBlMax, config);
     KHE_SOLN bestSoln = KheSolnCopy(soln);
+    elitePool.add(bestSoln);
 
     KHE_COST cost;
-    int perturbationSize = config.ilsPertIni;
+    int perturbationSize = config.state.ilsPerturbation > 0 ? config.state.ilsPerturbation : config.ilsPertIni;
     int iters = 0;
+    int relinkIters = 0;
     int neighborhood = 0;
     int pertubationChanges = 0;
 
+    // otimos locais ja visitados (hash das atribuicoes)
+    set< uint64_t > visitedOptima;
+    visitedOptima.insert(KheSolnAssignHash(soln));
+
     while (config.getRemainingTime() > 0 && pertubationChanges < config.ilsIters) {
         restartMoves();
         for (int j = 0; j < perturbationSize; ++j) {
@@ -532,20 +981,36 @@ KHE_SOLN ils(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
             generateNeighbor(soln, instance, neighborhood);
         }
 
-        cost = KheSolnCost(soln);
-        printf("PERTURBED Level %d Hard cost: %d   Soft cost: %d\n", perturbationSize, KheHardCost(cost), KheSoftCost(cost));
-        soln = descent(soln, bestSoln, instance, config.ilsBlMax, config);
-
-        // Houve melhora na solucao?
-        if (isBetterSolution(soln, bestSoln)) {
-            KheSolnDelete(bestSoln);
-            bestSoln = KheSolnCopy(soln);
-            perturbationSize = config.ilsPertIni;
-            iters = 0;
-        } else {
+        // perturbacao fraca demais: a solucao ainda e um otimo ja visitado
+        if (visitedOptima.count(KheSolnAssignHash(soln))) {
             KheSolnDelete(soln);
             soln = KheSolnCopy(bestSoln);
+            if (perturbationSize < config.ilsPertMax)
+                perturbationSize++;
             iters++;
+        } else {
+            cost = KheSolnCost(soln);
+            printf("PERTURBED Level %d Hard cost: %d   Soft cost: %d\n", perturbationSize, KheHardCost(cost), KheSoftCost(cost));
+            soln = descent(soln, bestSoln, instance, config.ilsBlMax, config);
+            bool revisited = !visitedOptima.insert(KheSolnAssignHash(soln)).second;
+            if (!revisited)
+                elitePool.add(soln);
+
+            // Houve melhora na solucao?
+            if (isBetterSolution(soln, bestSoln)) {
+                KheSolnDelete(bestSoln);
+                bestSoln = KheSolnCopy(soln);
+                perturbationSize = config.ilsPertIni;
+                iters = 0;
+            } else {
+                KheSolnDelete(soln);
+                soln = KheSolnCopy(bestSoln);
+                iters++;
+
+                // a descida caiu num otimo ja conhecido: perturba mais forte
+                if (revisited && perturbationSize < config.ilsPertMax)
+                    perturbationSize++;
+            }
         }
 
         if (iters >= config.ilsMax) {
@@ -553,12 +1018,86 @@ KHE_SOLN ils(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
             perturbationSize = (config.ilsPertIni + 1) % (config.ilsPertMax + 1);
             pertubationChanges++;
         }
+
+        // path relinking entre os otimos guardados; o melhor intermediario
+        // passa pela descida e pode virar a melhor solucao
+        if (config.elite > 0 && ++relinkIters >= config.eliteEvery && config.getRemainingTime() > 0) {
+            relinkIters = 0;
+            KHE_SOLN relinked = relinkElites(bestSoln, instance, config);
+            if (relinked != NULL) {
+                relinked = descent(relinked, bestSoln, instance, config.ilsBlMax, config);
+                elitePool.add(relinked);
+                cost = KheSolnCost(relinked);
+                printf("RELINKED Hard cost: %d   Soft cost: %d\n", KheHardCost(cost), KheSoftCost(cost));
+                if (isBetterSolution(relinked, bestSoln)) {
+                    KheSolnDelete(bestSoln);
+                    bestSoln = KheSolnCopy(relinked);
+                    KheSolnDelete(soln);
+                    soln = relinked;
+                    perturbationSize = config.ilsPertIni;
+                    iters = 0;
+                } else
+                    KheSolnDelete(relinked);
+            }
+        }
     }
 
+    config.state.ilsPerturbation = perturbationSize;
     KheSolnDelete(soln);
     return bestSoln;
 }
 
+// Rodada de path relinking: pares sorteados do pool de elite sao religados
+// nas copias da solucao (cada copia parte de uma ponta do par e caminha ate a
+// outra; as copias rodam em paralelo) e os melhores intermediarios voltam
+// para o pool. Devolve o melhor deles como solucao nova, ou NULL se nenhum
+// caminho teve intermediarios. So entram as solucoes do pool com a forma da
+// solucao atual (meets divididos/juntados mudam a forma).
+KHE_SOLN relinkElites(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    uint64_t shape = solnShape(soln);
+    vector< int > members;
+    for (int i = 0; i < elitePool.size(); i++)
+        if (elitePool.solution(i).shape == shape)
+            members.push_back(i);
+    if (members.size() < 2) return NULL;
+
+    int pairs = config.eliteRelinks > 0 ? config.eliteRelinks : relinkPool.size();
+    vector< pair< int, int > > ends(pairs);
+    vector< unsigned > seeds(pairs);
+    for (int p = 0; p < pairs; p++) {
+        int a = rand() % members.size();
+        int b = rand() % (members.size() - 1);
+        if (b >= a) b++;
+        ends[p] = make_pair(members[a], members[b]);
+        seeds[p] = rand();
+    }
+
+    vector< EliteSolution > results(pairs);
+    vector< char > found(pairs, false);
+    if (!relinkPool.align(soln)) return NULL;
+    relinkPool.run([&](int id, KHE_SOLN replica) {
+        for (int p = id; p < pairs; p += relinkPool.size()) {
+            applyElite(replica, instance, elitePool.solution(ends[p].first));
+            found[p] = relinkPath(replica, instance, elitePool.solution(ends[p].second),
+                                  config.relinkCandidates, seeds[p], config, results[p]);
+        }
+    });
+
+    int best = -1;
+    for (int p = 0; p < pairs; p++) {
+        if (!found[p]) continue;
+        if (best < 0 || results[p].cost < results[best].cost)
+            best = p;
+    }
+    if (best < 0) return NULL;
+    KHE_SOLN relinked = KheSolnCopy(soln);
+    applyElite(relinked, instance, results[best]);
+    for (int p = 0; p < pairs; p++)
+        if (found[p])
+            elitePool.add(results[p]);
+    return relinked;
+}
+
 KHE_SOLN vns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
 
     int bestHardFitness = KheHardCost(KheSolnCost(soln));
@@ -576,7 +1115,9 @@ KHE_SOLN vns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
         hasMove = true;
         neighborhoodImprove = false;
         if (neighborhood != PERMUT_RESOURCES &&
-                ((neighborhood != TASK_RESOURCE_SWAP && neighborhood != TASK_SWAP) || config.assignResourcesConst == true)) {
+                ((neighborhood != TASK_RESOURCE_SWAP && neighborhood != TASK_SWAP && neighborhood != TWO_COLOUR_REASSIGN) ||
+                config.assignResourcesConst == true) &&
+                ((neighborhood != MEET_SPLIT && neighborhood != MEET_MERGE) || splitMoves)) {
             for (int i = 0; i < config.vnsMax && hasMove && config.getRemainingTime() > 0; ++i) {
                 KHE_TRANSACTION t = KheTransactionMake(soln);
                 KheTransactionBegin(t);
@@ -591,18 +1132,22 @@ KHE_SOLN vns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
                     printToLog(soln, config, neighborhood, i, 0.0);
                     neighborhoodImprove = true;
                     KheTransactionDelete(t);
+                    telemetry.iteration(soln, neighborhood, true);
                     break;
                 } else if (neighborHardFitness > bestHardFitness || neighborSoftFitness > bestSoftFitness) {
                     // caso a solucao seja pior que a anterior
                     KheTransactionUndo(t); // desfaz o movimento
                     KheTransactionDelete(t); // desfaz o movimento
+                    telemetry.iteration(soln, neighborhood, false);
+                } else {
+                    telemetry.iteration(soln, neighborhood, true);
                 }
             }
         }
         if (neighborhoodImprove)
             neighborhood = startingNeighborhood;
         else
-            if (neighborhood + 1 == MAX_NEIGHBOR)
+            if (neighborhood == MAX_NEIGHBOR)
             neighborhood = startingNeighborhood;
         else
             ++neighborhood;
@@ -617,7 +1162,7 @@ KHE_SOLN rvns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
     KHE_COST cost;
     int bestHardFitness = KheHardCost(KheSolnCost(soln));
     int bestSoftFitness = KheSoftCost(KheSolnCost(soln));
-    int neighborhood = (rand() % (MAX_NEIGHBOR - 1)) + 1;
+    int neighborhood = (rand() % MAX_NEIGHBOR) + 1;
     
     bool hasMove;
     int neighborHardFitness;
@@ -627,7 +1172,9 @@ KHE_SOLN rvns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
         restartMoves();
         hasMove = true;
         if (neighborhood != PERMUT_RESOURCES &&
-                ((neighborhood != TASK_RESOURCE_SWAP && neighborhood != TASK_SWAP) || config.assignResourcesConst == true)) {
+                ((neighborhood != TASK_RESOURCE_SWAP && neighborhood != TASK_SWAP && neighborhood != TWO_COLOUR_REASSIGN) ||
+                config.assignResourcesConst == true) &&
+                ((neighborhood != MEET_SPLIT && neighborhood != MEET_MERGE) || splitMoves)) {
             for (int i = 0; i < config.vnsMax && hasMove && config.getRemainingTime() > 0; ++i) {
                 KHE_TRANSACTION t = KheTransactionMake(soln);
                 KheTransactionBegin(t);
@@ -641,24 +1188,772 @@ KHE_SOLN rvns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
                     bestSoftFitness = neighborSoftFitness;
                     printToLog(soln, config, neighborhood, i, 0.0);
                     KheTransactionDelete(t);
+                    telemetry.iteration(soln, neighborhood, true);
                     break;
                 } else if (neighborHardFitness > bestHardFitness || neighborSoftFitness > bestSoftFitness) {
                     // caso a solucao seja pior que a anterior
                     KheTransactionUndo(t); // desfaz o movimento
                     KheTransactionDelete(t); // desfaz o movimento
+                    telemetry.iteration(soln, neighborhood, false);
+                } else {
+                    telemetry.iteration(soln, neighborhood, true);
                 }
             }
         }
-        neighborhood = (rand() % (MAX_NEIGHBOR - 1)) + 1;
+        neighborhood = (rand() % MAX_NEIGHBOR) + 1;
     }
     return soln;
 }
 
+KHE_SOLN tabuSearch(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    KHE_SOLN bestSoln = KheSolnCopy(soln);
+    KHE_COST bestCost = KheSolnCost(bestSoln);
+
+    // lista tabu: iteracao ate a qual cada atributo (meet, time) e
+    // (task, resource) nao pode ser reintroduzido
+    int timeCount = KheInstanceTimeCount(instance);
+    int resourceCount = KheInstanceResourceCount(instance);
+    vector< int > meetTabu(KheSolnMeetCount(soln) * timeCount, 0);
+    vector< int > taskTabu(KheSolnTaskCount(soln) * resourceCount, 0);
+
+    // copias da solucao para avaliar os candidatos em paralelo
+    ReplicaPool pool;
+    if (config.threads > 1)
+        pool.configure(soln, config.threads);
+
+    int candidateCount = config.tabuCandidates;
+    vector< TabuMove > candidates(candidateCount);
+    vector< KHE_COST > costs(candidateCount);
+    vector< int > valid(candidateCount);
+    vector< pair< int, int > > meetAttrs, taskAttrs;
+    TabuMove last;
+    bool pending = false;
+
+    int iter = 0, noImprove = 0;
+    while (config.getRemainingTime() > 0) {
+        iter++;
+
+        // busca estagnada: recomeca da melhor solucao
+        if (noImprove >= config.tabuMax) {
+            KheSolnDelete(soln);
+            soln = KheSolnCopy(bestSoln);
+            pool.sync(soln);
+            pending = false;
+            noImprove = 0;
+        }
+
+        for (int i = 0; i < candidateCount; i++)
+            candidates[i] = sampleTabuMove(soln, instance, config);
+
+        if (pool.size() > 0) {
+            // as copias aplicam o movimento da iteracao anterior antes de avaliar
+            int workers = pool.size();
+            pool.run([&](int id, KHE_SOLN replica) {
+                if (pending) applyTabuMove(replica, instance, last);
+                for (int i = id; i < candidateCount; i += workers)
+                    costs[i] = evaluateTabuMove(replica, instance, candidates[i], valid[i]);
+            });
+        } else {
+            for (int i = 0; i < candidateCount; i++)
+                costs[i] = evaluateTabuMove(soln, instance, candidates[i], valid[i]);
+        }
+        pending = false;
+
+        // melhor candidato nao tabu, ou tabu que melhora a melhor solucao
+        int chosen = -1;
+        for (int i = 0; i < candidateCount; i++) {
+            if (!valid[i] || (chosen != -1 && !isBetterSolution(costs[i], costs[chosen])))
+                continue;
+            if (isBetterSolution(costs[i], bestCost) ||
+                    !isTabuMove(soln, instance, candidates[i], meetTabu, taskTabu, iter))
+                chosen = i;
+        }
+
+        if (chosen == -1) {
+            noImprove++;
+            telemetry.iteration(soln, 0, false);
+            continue;
+        }
+
+        // os atributos desfeitos pelo movimento passam a ser tabu
+        TabuMove &move = candidates[chosen];
+        tabuAttributes(soln, instance, move, false, meetAttrs, taskAttrs);
+        for (int i = 0; i < meetAttrs.size(); i++)
+            meetTabu[meetAttrs[i].first * timeCount + meetAttrs[i].second] = iter + config.tabuTenure;
+        for (int i = 0; i < taskAttrs.size(); i++)
+            taskTabu[taskAttrs[i].first * resourceCount + taskAttrs[i].second] = iter + config.tabuTenure;
+
+        applyTabuMove(soln, instance, move);
+        last = move;
+        pending = true;
+        telemetry.iteration(soln, move.neighborhood, true);
+
+        if (isBetterSolution(soln, bestCost)) {
+            KheSolnDelete(bestSoln);
+            bestSoln = KheSolnCopy(soln);
+            bestCost = KheSolnCost(bestSoln);
+            printToLog(soln, config, move.neighborhood, iter, 0.0);
+            noImprove = 0;
+        } else {
+            noImprove++;
+        }
+    }
+
+    pool.clear();
+    KheSolnDelete(soln);
+    return bestSoln;
+}
+
+KHE_SOLN lns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    // grupos de horarios de um dia; na falta deles, todos os grupos
+    vector< int > days;
+    for (int i = 0; i < KheInstanceTimeGroupCount(instance); i++)
+        if (KheTimeGroupKind(KheInstanceTimeGroup(instance, i)) == KHE_TIME_GROUP_KIND_DAY)
+            days.push_back(i);
+    if (days.empty())
+        for (int i = 0; i < KheInstanceTimeGroupCount(instance); i++)
+            days.push_back(i);
+
+    // copias da solucao para avaliar as tentativas em paralelo
+    ReplicaPool pool;
+    if (config.threads > 1)
+        pool.configure(soln, config.threads);
+
+    int attemptCount = config.lnsAttempts;
+    vector< LnsMove > attempts(attemptCount);
+    vector< KHE_COST > costs(attemptCount);
+    vector< int > valid(attemptCount);
+
+    int iter = 0;
+    while (config.getRemainingTime() > 0) {
+        iter++;
+        for (int i = 0; i < attemptCount; i++)
+            attempts[i] = sampleLnsMove(instance, days);
+
+        if (pool.size() > 0) {
+            int workers = pool.size();
+            pool.align(soln);
+            pool.run([&](int id, KHE_SOLN replica) {
+                for (int i = id; i < attemptCount; i += workers)
+                    costs[i] = evaluateLnsMove(replica, instance, attempts[i], config, valid[i]);
+            });
+        } else {
+            for (int i = 0; i < attemptCount; i++)
+                costs[i] = evaluateLnsMove(soln, instance, attempts[i], config, valid[i]);
+        }
+
+        int chosen = -1;
+        for (int i = 0; i < attemptCount; i++)
+            if (valid[i] && (chosen == -1 || isBetterSolution(costs[i], costs[chosen])))
+                chosen = i;
+
+        // o reparo e deterministico: refaz a melhor tentativa na solucao e
+        // aceita se o custo nao piorar
+        KHE_COST cost = KheSolnCost(soln);
+        bool accepted = false;
+        if (chosen != -1 && !isBetterSolution(cost, costs[chosen])) {
+            KHE_TRANSACTION t = KheTransactionMake(soln);
+            applyLnsMove(soln, instance, attempts[chosen], config, t);
+            accepted = !isBetterSolution(cost, KheSolnCost(soln));
+            if (!accepted)
+                KheTransactionUndo(t);
+            KheTransactionDelete(t);
+
+            if (accepted && isBetterSolution(soln, cost))
+                printToLog(soln, config, LNS_STEP, iter, 0.0);
+        }
+        telemetry.iteration(soln, chosen == -1 ? 0 : LNS_STEP, accepted);
+    }
+
+    pool.clear();
+    return soln;
+}
+
+//=====================================================
+// Busca Tabu
+//=====================================================
+
+TabuMove sampleTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    TabuMove move;
+    int kind = rand() % 100;
+
+    // movimentos de recursos so quando a atribuicao de recursos esta ativa
+    if (config.assignResourcesConst == true && KheSolnTaskCount(soln) > 1 && kind >= 50) {
+        if (kind < 75) {
+            move.neighborhood = TASK_RESOURCE_SWAP;
+            pair< int, int > target = getTaskResourceMove(soln, instance);
+            move.first = target.first;
+            move.second = target.second;
+        } else {
+            move.neighborhood = TASK_SWAP;
+            move.first = rand() % KheSolnTaskCount(soln);
+            move.second = rand() % KheSolnTaskCount(soln);
+        }
+    } else {
+        if (kind % 2 == 0) {
+            move.neighborhood = MEET_TIME_CHANGE;
+            pair< int, int > target = getMeetTimeMove(soln, instance);
+            move.first = target.first;
+            move.second = target.second;
+        } else {
+            move.neighborhood = MEET_SWAP;
+            move.first = rand() % KheSolnMeetCount(soln);
+            move.second = rand() % KheSolnMeetCount(soln);
+        }
+    }
+    return move;
+}
+
+bool applyTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move) {
+    if (move.first < 0)
+        return false;
+    if (move.neighborhood == MEET_TIME_CHANGE) {
+        KHE_MEET meet = KheSolnMeet(soln, move.first);
+        return !KheMeetIsCycleMeet(meet) && KheMeetMoveTime(meet, KheInstanceTime(instance, move.second));
+    } else if (move.neighborhood == MEET_SWAP) {
+        KHE_MEET meet1 = KheSolnMeet(soln, move.first), meet2 = KheSolnMeet(soln, move.second);
+        return !KheMeetIsCycleMeet(meet1) && !KheMeetIsCycleMeet(meet2) && KheMeetSwap(meet1, meet2);
+    } else if (move.neighborhood == TASK_RESOURCE_SWAP) {
+        KHE_TASK task = KheSolnTask(soln, move.first);
+        return !KheTaskIsCycle(task) && KheTaskMoveResource(task, KheInstanceResource(instance, move.second));
+    } else if (move.neighborhood == TASK_SWAP) {
+        KHE_TASK task1 = KheSolnTask(soln, move.first), task2 = KheSolnTask(soln, move.second);
+        return !KheTaskIsCycle(task1) && !KheTaskIsCycle(task2) && KheTaskSwap(task1, task2);
+    }
+    return false;
+}
+
+KHE_COST evaluateTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move, int &valid) {
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    KheTransactionBegin(t);
+    valid = applyTabuMove(soln, instance, move);
+    KheTransactionEnd(t);
+    KHE_COST cost = KheSolnCost(soln);
+    KheTransactionUndo(t);
+    KheTransactionDelete(t);
+    return cost;
+}
+
+// Atributos (meet, time) e (task, resource) do movimento: os que ele
+// desfaz (after == false) ou os que ele cria (after == true)
+void tabuAttributes(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move, bool after,
+        vector< pair< int, int > > &meetAttrs, vector< pair< int, int > > &taskAttrs) {
+    meetAttrs.clear();
+    taskAttrs.clear();
+
+    if (move.neighborhood == MEET_TIME_CHANGE || move.neighborhood == MEET_SWAP) {
+        KHE_TIME time1 = KheMeetAsstTime(KheSolnMeet(soln, move.first));
+        KHE_TIME time2 = move.neighborhood == MEET_TIME_CHANGE ? KheInstanceTime(instance, move.second) :
+                KheMeetAsstTime(KheSolnMeet(soln, move.second));
+        if (after) {
+            if (time2 != NULL) meetAttrs.push_back(pair< int, int >(move.first, KheTimeIndex(time2)));
+            if (move.neighborhood == MEET_SWAP && time1 != NULL)
+                meetAttrs.push_back(pair< int, int >(move.second, KheTimeIndex(time1)));
+        } else {
+            if (time1 != NULL) meetAttrs.push_back(pair< int, int >(move.first, KheTimeIndex(time1)));
+            if (move.neighborhood == MEET_SWAP && time2 != NULL)
+                meetAttrs.push_back(pair< int, int >(move.second, KheTimeIndex(time2)));
+        }
+    } else {
+        KHE_RESOURCE res1 = KheTaskAsstResource(KheSolnTask(soln, move.first));
+        KHE_RESOURCE res2 = move.neighborhood == TASK_RESOURCE_SWAP ? KheInstanceResource(instance, move.second) :
+                KheTaskAsstResource(KheSolnTask(soln, move.second));
+        if (after) {
+            if (res2 != NULL) taskAttrs.push_back(pair< int, int >(move.first, KheResourceIndexInInstance(res2)));
+            if (move.neighborhood == TASK_SWAP && res1 != NULL)
+                taskAttrs.push_back(pair< int, int >(move.second, KheResourceIndexInInstance(res1)));
+        } else {
+            if (res1 != NULL) taskAttrs.push_back(pair< int, int >(move.first, KheResourceIndexInInstance(res1)));
+            if (move.neighborhood == TASK_SWAP && res2 != NULL)
+                taskAttrs.push_back(pair< int, int >(move.second, KheResourceIndexInInstance(res2)));
+        }
+    }
+}
+
+bool isTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move, vector< int > &meetTabu, vector< int > &taskTabu, int iter) {
+    vector< pair< int, int > > meetAttrs, taskAttrs;
+    tabuAttributes(soln, instance, move, true, meetAttrs, taskAttrs);
+
+    for (int i = 0; i < meetAttrs.size(); i++)
+        if (meetTabu[meetAttrs[i].first * KheInstanceTimeCount(instance) + meetAttrs[i].second] > iter)
+            return true;
+    for (int i = 0; i < taskAttrs.size(); i++)
+        if (taskTabu[taskAttrs[i].first * KheInstanceResourceCount(instance) + taskAttrs[i].second] > iter)
+            return true;
+    return false;
+}
+
+//=====================================================
+// Busca em Vizinhanca Grande (LNS)
+//=====================================================
+
+// O reparo atribui cada meet a um cycle meet distinto dos seus irmaos: o
+// cycle meet unico inicial e dividido nos pontos que a instancia permite.
+// Muda os meets da solucao, por isso vem antes de configureMoves.
+void lnsPrepare(KHE_SOLN soln) {
+    int cycleMeets = 0;
+    for (int i = 0; i < KheSolnMeetCount(soln); i++)
+        if (KheMeetIsCycleMeet(KheSolnMeet(soln, i))) cycleMeets++;
+    if (cycleMeets == 1)
+        KheSolnSplitCycleMeet(soln);
+}
+
+LnsMove sampleLnsMove(KHE_INSTANCE instance, vector< int > &days) {
+    LnsMove move;
+    move.destroy = rand() % LNS_DESTROY_COUNT;
+    if (move.destroy == LNS_DAY)
+        move.target = days[rand() % days.size()];
+    else
+        move.target = rand() % KheInstanceResourceCount(instance);
+    move.seed = rand();
+    return move;
+}
+
+// Meets (e, com atribuicao de recursos, tasks) desfeitos pelo passo. So
+// entram meets livres atribuidos direto a um cycle meet; a ordem e a dos
+// indices, para que o reparo seja igual em qualquer copia da solucao.
+void lnsRegion(KHE_SOLN soln, KHE_INSTANCE instance, LnsMove &move, Config &config, vector< KHE_MEET > &meets, vector< KHE_TASK > &tasks) {
+    vector< int > indices;
+    meets.clear();
+    tasks.clear();
+
+    if (move.destroy == LNS_RESOURCE) {
+        // tudo o que esta atribuido ao recurso
+        KHE_RESOURCE resource = KheInstanceResource(instance, move.target);
+        KHE_RESOURCE preassigned;
+        for (int i = 0; i < KheResourceAssignedTaskCount(soln, resource); i++) {
+            KHE_TASK task = KheResourceAssignedTask(soln, resource, i);
+            if (KheTaskMeet(task) != NULL)
+                indices.push_back(KheMeetIndex(KheTaskMeet(task)));
+            if (config.assignResourcesConst && !KheTaskIsCycle(task) && KheTaskTasking(task) == NULL &&
+                    !KheTaskIsPreassigned(task, false, &preassigned))
+                tasks.push_back(task);
+        }
+    } else if (move.destroy == LNS_LAYER) {
+        // eventos em que o recurso e pre-atribuido
+        KHE_RESOURCE resource = KheInstanceResource(instance, move.target);
+        for (int i = 0; i < KheResourceLayerEventCount(resource); i++) {
+            KHE_EVENT event = KheResourceLayerEvent(resource, i);
+            for (int j = 0; j < KheEventMeetCount(soln, event); j++)
+                indices.push_back(KheMeetIndex(KheEventMeet(soln, event, j)));
+        }
+    } else {
+        // meets que ocupam algum horario do dia
+        KHE_TIME_GROUP day = KheInstanceTimeGroup(instance, move.target);
+        for (int i = 0; i < KheSolnMeetCount(soln); i++) {
+            KHE_TIME time = KheMeetAsstTime(KheSolnMeet(soln, i));
+            if (time != NULL && KheTimeGroupContains(day, time))
+                indices.push_back(i);
+        }
+    }
+
+    sort(indices.begin(), indices.end());
+    indices.erase(unique(indices.begin(), indices.end()), indices.end());
+
+    KHE_TIME preassignedTime;
+    for (int i = 0; i < indices.size(); i++) {
+        KHE_MEET meet = KheSolnMeet(soln, indices[i]);
+        if (KheMeetIsCycleMeet(meet) || KheMeetNode(meet) != NULL ||
+                KheMeetIsPreassigned(meet, true, &preassignedTime) || KheMeetIsPreassigned(meet, false, &preassignedTime))
+            continue;
+        if (KheMeetAsst(meet) == NULL || KheMeetIsCycleMeet(KheMeetAsst(meet)))
+            meets.push_back(meet);
+    }
+}
+
+// Insercao gulosa da regiao: desatribui os meets e os reinsere, dos mais
+// longos aos mais curtos, cada um na posicao de menor custo. A ordem entre
+// meets de mesma duracao e os empates sao sorteados com seed: a insercao
+// deterministica do KHE (KheNodeSimpleAssignTimes) quase sempre reconstruia
+// a regiao como estava.
+void lnsInsert(KHE_SOLN soln, KHE_NODE root, vector< KHE_MEET > &meets, unsigned seed) {
+    mt19937 random(seed);
+    vector< KHE_MEET > order(meets);
+    shuffle(order.begin(), order.end(), random);
+    stable_sort(order.begin(), order.end(), [](KHE_MEET a, KHE_MEET b) {
+        return KheMeetDuration(a) > KheMeetDuration(b);
+    });
+    for (int i = 0; i < order.size(); i++)
+        if (KheMeetAsst(order[i]) != NULL)
+            KheMeetUnAssign(order[i]);
+
+    for (int i = 0; i < order.size(); i++) {
+        KHE_MEET meet = order[i];
+        KHE_MEET bestTarget = NULL;
+        int bestOffset = 0, ties = 0;
+        KHE_COST bestCost = 0;
+        for (int j = 0; j < KheNodeMeetCount(root); j++) {
+            KHE_MEET target = KheNodeMeet(root, j);
+            for (int offset = 0; offset <= KheMeetDuration(target) - KheMeetDuration(meet); offset++) {
+                if (!KheMeetAssign(meet, target, offset)) continue;
+                KHE_COST cost = KheSolnCost(soln);
+                KheMeetUnAssign(meet);
+                if (bestTarget == NULL || isBetterSolution(cost, bestCost)) {
+                    ties = 1;
+                } else if (cost == bestCost) {
+                    if (random() % ++ties != 0) continue;
+                } else {
+                    continue;
+                }
+                bestTarget = target;
+                bestOffset = offset;
+                bestCost = cost;
+            }
+        }
+        if (bestTarget != NULL)
+            KheMeetAssign(meet, bestTarget, bestOffset);
+    }
+}
+
+// A insercao gulosa decide cada meet sem conhecer os seguintes:
+// cada meet da regiao e reinserido na melhor posicao dada a dos demais,
+// ate nenhuma reinsercao melhorar o custo
+void lnsReinsert(KHE_SOLN soln, KHE_NODE root, vector< KHE_MEET > &meets) {
+    bool improved = true;
+    for (int pass = 0; pass < LNS_REPAIR_PASSES && improved; pass++) {
+        improved = false;
+        for (int i = 0; i < meets.size(); i++) {
+            KHE_MEET meet = meets[i];
+            KHE_MEET bestTarget = KheMeetAsst(meet);
+            int bestOffset = KheMeetAsstOffset(meet);
+            KHE_COST bestCost = KheSolnCost(soln);
+
+            for (int j = 0; j < KheNodeMeetCount(root); j++) {
+                KHE_MEET target = KheNodeMeet(root, j);
+                for (int offset = 0; offset <= KheMeetDuration(target) - KheMeetDuration(meet); offset++) {
+                    if (target == KheMeetAsst(meet) && offset == KheMeetAsstOffset(meet)) continue;
+                    if (!KheMeetMoveCheck(meet, target, offset)) continue;
+                    KHE_MEET oldTarget = KheMeetAsst(meet);
+                    int oldOffset = KheMeetAsstOffset(meet);
+                    KheMeetMove(meet, target, offset);
+                    if (isBetterSolution(soln, bestCost)) {
+                        bestTarget = target;
+                        bestOffset = offset;
+                        bestCost = KheSolnCost(soln);
+                    }
+                    KheMeetMove(meet, oldTarget, oldOffset);
+                }
+            }
+
+            if (bestTarget != KheMeetAsst(meet) || bestOffset != KheMeetAsstOffset(meet)) {
+                KheMeetMove(meet, bestTarget, bestOffset);
+                improved = true;
+            }
+        }
+    }
+}
+
+// Destroi e reconstroi a regiao do passo dentro de t. A insercao trabalha
+// sobre nos: a raiz recebe os cycle meets e um filho os meets da regiao. Esse andaime e montado e desfeito fora de t, que so
+// registra as atribuicoes e pode ser desfeita.
+bool applyLnsMove(KHE_SOLN soln, KHE_INSTANCE instance, LnsMove &move, Config &config, KHE_TRANSACTION t) {
+    vector< KHE_MEET > meets;
+    vector< KHE_TASK > tasks;
+    lnsRegion(soln, instance, move, config, meets, tasks);
+    if (meets.empty() && tasks.empty())
+        return false;
+
+    KHE_NODE root = KheNodeMake(soln);
+    for (int i = 0; i < KheSolnMeetCount(soln); i++)
+        if (KheMeetIsCycleMeet(KheSolnMeet(soln, i)))
+            KheNodeAddMeet(root, KheSolnMeet(soln, i));
+    KHE_NODE region = KheNodeMake(soln);
+    KheNodeAddParent(region, root);
+    for (int i = 0; i < meets.size(); i++)
+        KheNodeAddMeet(region, meets[i]);
+
+    KHE_TASKING tasking = NULL;
+    if (!tasks.empty()) {
+        tasking = KheTaskingMake(soln, NULL);
+        for (int i = 0; i < tasks.size(); i++)
+            KheTaskingAddTask(tasking, tasks[i]);
+    }
+
+    KheTransactionBegin(t);
+    for (int i = 0; i < tasks.size(); i++)
+        if (KheTaskAsst(tasks[i]) != NULL)
+            KheTaskUnAssign(tasks[i]);
+    if (!meets.empty()) {
+        lnsInsert(soln, root, meets, move.seed);
+        lnsReinsert(soln, root, meets);
+    }
+    if (tasking != NULL)
+        KheMostConstrainedFirstAssignResources(tasking);
+    KheTransactionEnd(t);
+
+    if (tasking != NULL)
+        KheTaskingDelete(tasking);
+    KheNodeDelete(region);
+    KheNodeDelete(root);
+    return true;
+}
+
+KHE_COST evaluateLnsMove(KHE_SOLN soln, KHE_INSTANCE instance, LnsMove &move, Config &config, int &valid) {
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    valid = applyLnsMove(soln, instance, move, config, t);
+    KHE_COST cost = KheSolnCost(soln);
+    if (valid)
+        KheTransactionUndo(t);
+    KheTransactionDelete(t);
+    return cost;
+}
+
+//=====================================================
+// Trocas de Meets em Defeito
+//=====================================================
+
+void markEventMeets(KHE_SOLN soln, KHE_EVENT event, vector< char > &marked) {
+    for (int i = 0; i < KheEventMeetCount(soln, event); i++)
+        marked[KheMeetIndex(KheEventMeet(soln, event, i))] = true;
+}
+
+void markResourceMeets(KHE_SOLN soln, KHE_RESOURCE resource, vector< char > &marked) {
+    for (int i = 0; i < KheResourceAssignedTaskCount(soln, resource); i++) {
+        KHE_MEET meet = KheTaskMeet(KheResourceAssignedTask(soln, resource, i));
+        if (meet != NULL)
+            marked[KheMeetIndex(meet)] = true;
+    }
+}
+
+// Meets envolvidos em algum monitor com custo, em ordem de indice
+void defectMeets(KHE_SOLN soln, vector< int > &meets) {
+    vector< char > marked(KheSolnMeetCount(soln), false);
+
+    for (int i = 0; i < KheSolnDefectCount(soln); i++) {
+        KHE_MONITOR m = KheSolnDefect(soln, i);
+        KHE_EVENT_GROUP eg = NULL;
+        switch (KheMonitorTag(m)) {
+            case KHE_ASSIGN_TIME_MONITOR_TAG:
+                markEventMeets(soln, KheAssignTimeMonitorEvent((KHE_ASSIGN_TIME_MONITOR) m), marked);
+                break;
+            case KHE_PREFER_TIMES_MONITOR_TAG:
+                markEventMeets(soln, KhePreferTimesMonitorEvent((KHE_PREFER_TIMES_MONITOR) m), marked);
+                break;
+            case KHE_SPLIT_EVENTS_MONITOR_TAG:
+                markEventMeets(soln, KheSplitEventsMonitorEvent((KHE_SPLIT_EVENTS_MONITOR) m), marked);
+                break;
+            case KHE_DISTRIBUTE_SPLIT_EVENTS_MONITOR_TAG:
+                markEventMeets(soln, KheDistributeSplitEventsMonitorEvent((KHE_DISTRIBUTE_SPLIT_EVENTS_MONITOR) m), marked);
+                break;
+            case KHE_SPREAD_EVENTS_MONITOR_TAG:
+                eg = KheSpreadEventsMonitorEventGroup((KHE_SPREAD_EVENTS_MONITOR) m);
+                break;
+            case KHE_LINK_EVENTS_MONITOR_TAG:
+                eg = KheLinkEventsMonitorEventGroup((KHE_LINK_EVENTS_MONITOR) m);
+                break;
+            case KHE_AVOID_CLASHES_MONITOR_TAG:
+                markResourceMeets(soln, KheAvoidClashesMonitorResource((KHE_AVOID_CLASHES_MONITOR) m), marked);
+                break;
+            case KHE_AVOID_UNAVAILABLE_TIMES_MONITOR_TAG:
+                markResourceMeets(soln, KheAvoidUnavailableTimesMonitorResource((KHE_AVOID_UNAVAILABLE_TIMES_MONITOR) m), marked);
+                break;
+            case KHE_LIMIT_IDLE_TIMES_MONITOR_TAG:
+                markResourceMeets(soln, KheLimitIdleTimesMonitorResource((KHE_LIMIT_IDLE_TIMES_MONITOR) m), marked);
+                break;
+            case KHE_CLUSTER_BUSY_TIMES_MONITOR_TAG:
+                markResourceMeets(soln, KheClusterBusyTimesMonitorResource((KHE_CLUSTER_BUSY_TIMES_MONITOR) m), marked);
+                break;
+            case KHE_LIMIT_BUSY_TIMES_MONITOR_TAG:
+                markResourceMeets(soln, KheLimitBusyTimesMonitorResource((KHE_LIMIT_BUSY_TIMES_MONITOR) m), marked);
+                break;
+            case KHE_LIMIT_WORKLOAD_MONITOR_TAG:
+                markResourceMeets(soln, KheLimitWorkloadMonitorResource((KHE_LIMIT_WORKLOAD_MONITOR) m), marked);
+                break;
+            case KHE_ORDINARY_DEMAND_MONITOR_TAG: {
+                KHE_MEET meet = KheTaskMeet(KheOrdinaryDemandMonitorTask((KHE_ORDINARY_DEMAND_MONITOR) m));
+                if (meet != NULL)
+                    marked[KheMeetIndex(meet)] = true;
+                break;
+            }
+            default:
+                // monitores de recursos de eventos nao dependem dos horarios
+                break;
+        }
+        if (eg != NULL)
+            for (int j = 0; j < KheEventGroupEventCount(eg); j++)
+                markEventMeets(soln, KheEventGroupEvent(eg, j), marked);
+    }
+
+    meets.clear();
+    for (int i = 0; i < marked.size(); i++)
+        if (marked[i] && !KheMeetIsCycleMeet(KheSolnMeet(soln, i)) && KheMeetAsst(KheSolnMeet(soln, i)) != NULL)
+            meets.push_back(i);
+}
+
+// Pares (meet em defeito, outro meet atribuido); pares de dois meets em
+// defeito aparecem uma vez so
+void defectMeetSwaps(KHE_SOLN soln, vector< int > &defects, vector< pair< int, int > > &swaps) {
+    vector< char > isDefect(KheSolnMeetCount(soln), false);
+    for (int i = 0; i < defects.size(); i++)
+        isDefect[defects[i]] = true;
+
+    swaps.clear();
+    for (int i = 0; i < defects.size(); i++) {
+        KHE_MEET meet1 = KheSolnMeet(soln, defects[i]);
+        for (int j = 0; j < KheSolnMeetCount(soln); j++) {
+            KHE_MEET meet2 = KheSolnMeet(soln, j);
+            if (j == defects[i] || (isDefect[j] && j < defects[i])) continue;
+            if (KheMeetIsCycleMeet(meet2) || KheMeetAsst(meet2) == NULL) continue;
+            if (KheMeetAsst(meet1) == KheMeetAsst(meet2) && KheMeetAsstOffset(meet1) == KheMeetAsstOffset(meet2)) continue;
+            swaps.push_back(pair< int, int >(defects[i], j));
+        }
+    }
+}
+
+// Custo da solucao com os dois meets trocados; a solucao volta ao estado original
+KHE_COST evaluateMeetSwap(KHE_SOLN soln, pair< int, int > &swap, int &valid) {
+    KHE_MEET meet1 = KheSolnMeet(soln, swap.first);
+    KHE_MEET meet2 = KheSolnMeet(soln, swap.second);
+    valid = KheMeetSwap(meet1, meet2);
+    KHE_COST cost = KheSolnCost(soln);
+    if (valid)
+        KheMeetSwap(meet1, meet2);
+    return cost;
+}
+
+//=====================================================
+// Reatribuicao de Recursos em Duas Cores
+//=====================================================
+
+// Recursos envolvidos em algum monitor com custo, em ordem de indice
+void defectResources(KHE_SOLN soln, vector< int > &resources) {
+    KHE_INSTANCE instance = KheSolnInstance(soln);
+    vector< char > marked(KheInstanceResourceCount(instance), false);
+
+    for (int i = 0; i < KheSolnDefectCount(soln); i++) {
+        KHE_MONITOR m = KheSolnDefect(soln, i);
+        KHE_RESOURCE resource = NULL;
+        switch (KheMonitorTag(m)) {
+            case KHE_AVOID_SPLIT_ASSIGNMENTS_MONITOR_TAG: {
+                KHE_AVOID_SPLIT_ASSIGNMENTS_MONITOR asam = (KHE_AVOID_SPLIT_ASSIGNMENTS_MONITOR) m;
+                for (int j = 0; j < KheAvoidSplitAssignmentsMonitorResourceCount(asam); j++)
+                    marked[KheResourceIndexInInstance(KheAvoidSplitAssignmentsMonitorResource(asam, j))] = true;
+                break;
+            }
+            case KHE_AVOID_CLASHES_MONITOR_TAG:
+                resource = KheAvoidClashesMonitorResource((KHE_AVOID_CLASHES_MONITOR) m);
+                break;
+            case KHE_AVOID_UNAVAILABLE_TIMES_MONITOR_TAG:
+                resource = KheAvoidUnavailableTimesMonitorResource((KHE_AVOID_UNAVAILABLE_TIMES_MONITOR) m);
+                break;
+            case KHE_LIMIT_IDLE_TIMES_MONITOR_TAG:
+                resource = KheLimitIdleTimesMonitorResource((KHE_LIMIT_IDLE_TIMES_MONITOR) m);
+                break;
+            case KHE_CLUSTER_BUSY_TIMES_MONITOR_TAG:
+                resource = KheClusterBusyTimesMonitorResource((KHE_CLUSTER_BUSY_TIMES_MONITOR) m);
+                break;
+            case KHE_LIMIT_BUSY_TIMES_MONITOR_TAG:
+                resource = KheLimitBusyTimesMonitorResource((KHE_LIMIT_BUSY_TIMES_MONITOR) m);
+                break;
+            case KHE_LIMIT_WORKLOAD_MONITOR_TAG:
+                resource = KheLimitWorkloadMonitorResource((KHE_LIMIT_WORKLOAD_MONITOR) m);
+                break;
+            default:
+                break;
+        }
+        if (resource != NULL)
+            marked[KheResourceIndexInInstance(resource)] = true;
+    }
+
+    resources.clear();
+    for (int i = 0; i < marked.size(); i++)
+        if (marked[i])
+            resources.push_back(i);
+}
+
+// Pares de recursos do mesmo tipo com ao menos um deles em defeito; o
+// segundo e outro recurso em defeito quando o sorteio acha um, e senao
+// qualquer recurso do tipo
+void sampleResourcePairs(KHE_SOLN soln, KHE_INSTANCE instance, int count, vector< pair< int, int > > &pairs) {
+    vector< int > defects;
+    defectResources(soln, defects);
+
+    pairs.clear();
+    for (int i = 0; i < count && !defects.empty(); i++) {
+        KHE_RESOURCE r1 = KheInstanceResource(instance, defects[rand() % defects.size()]);
+        KHE_RESOURCE_TYPE rt = KheResourceResourceType(r1);
+        if (KheResourceTypeResourceCount(rt) < 2) continue;
+
+        KHE_RESOURCE r2 = KheInstanceResource(instance, defects[rand() % defects.size()]);
+        if (r2 == r1 || KheResourceResourceType(r2) != rt) {
+            do {
+                r2 = KheResourceTypeResource(rt, rand() % KheResourceTypeResourceCount(rt));
+            } while (r2 == r1);
+        }
+        pairs.push_back(pair< int, int >(KheResourceIndexInInstance(r1), KheResourceIndexInInstance(r2)));
+    }
+}
+
+// Custo da solucao com as tasks dos dois recursos redistribuidas; a
+// solucao volta ao estado original
+KHE_COST evaluateTwoColour(KHE_SOLN soln, KHE_INSTANCE instance, pair< int, int > &resources, int &valid) {
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    KheTransactionBegin(t);
+    valid = KheTwoColourReassign(soln, KheInstanceResource(instance, resources.first),
+            KheInstanceResource(instance, resources.second), false);
+    KheTransactionEnd(t);
+
+    KHE_COST cost = KheSolnCost(soln);
+    if (valid)
+        KheTransactionUndo(t);
+    KheTransactionDelete(t);
+    return cost;
+}
+
+// Redistribui as tasks de um par de recursos por KheTwoColourReassign, que
+// so muda a solucao se achar uma atribuicao dos componentes do grafo de
+// conflitos melhor que a atual. Com copias da solucao, cada thread avalia
+// um par e so o par que mais melhora e aplicado. Falso se nenhum par
+// sorteado pode ser redistribuido.
+bool twoColourReassign(KHE_SOLN soln, KHE_INSTANCE instance) {
+    vector< pair< int, int > > pairs;
+    sampleResourcePairs(soln, instance, max(1, twoColourPool.size()), pairs);
+    if (pairs.empty())
+        return false;
+
+    int chosen = 0;
+    if (twoColourPool.size() > 0 && pairs.size() > 1 && twoColourPool.align(soln)) {
+        vector< KHE_COST > costs(pairs.size());
+        vector< int > valid(pairs.size());
+        int workers = twoColourPool.size();
+        twoColourPool.run([&](int id, KHE_SOLN replica) {
+            for (int i = id; i < pairs.size(); i += workers)
+                costs[i] = evaluateTwoColour(replica, instance, pairs[i], valid[i]);
+        });
+
+        chosen = -1;
+        for (int i = 0; i < pairs.size(); i++)
+            if (valid[i] && (chosen == -1 || isBetterSolution(costs[i], costs[chosen])))
+                chosen = i;
+        if (chosen == -1)
+            return false;
+    }
+
+    // com copias, o par escolhido e reaplicado nelas pelo log da transacao
+    uint64_t from = KheSolnAssignHash(soln);
+    KHE_TRANSACTION t = KheTransactionMake(soln);
+    KheTransactionSetLogging(t, twoColourPool.size() > 0);
+    KheTransactionBegin(t);
+    KheTwoColourReassign(soln, KheInstanceResource(instance, pairs[chosen].first),
+            KheInstanceResource(instance, pairs[chosen].second), false);
+    KheTransactionEnd(t);
+    if (twoColourPool.size() > 0 && KheTransactionLogPortable(t)) {
+        vector< int > log(KheTransactionLogLength(t));
+        KheTransactionLogExport(t, log.data());
+        twoColourPool.replay(soln, from, log);
+    }
+    KheTransactionDelete(t);
+    return true;
+}
+
 //=====================================================
 // Heuristicas
 //=====================================================
 
 KHE_SOLN descent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, int iterMax, Config &config) {
+    if (config.bestDescent)
+        return bestDescent(soln, bestSoln, instance, config);
+
     int bestKnownHardFitness = KheHardCost(KheSolnCost(bestSoln));
     int bestKnownSoftFitness = KheSoftCost(KheSolnCost(bestSoln));
 
@@ -670,6 +1965,7 @@ KHE_SOLN descent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, int it
     while (hasMove && iter < iterMax && config.getRemainingTime() > 0) {
 
         // gera o vizinho e executa o movimento
+        refreshReplicas(soln);
         KHE_TRANSACTION t = KheTransactionMake(soln);
         KheTransactionBegin(t);
         neighborhood = 0;
@@ -677,6 +1973,7 @@ KHE_SOLN descent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, int it
         KheTransactionEnd(t);
 
         // verifica se houve melhora na solucao
+        bool accepted = true;
         int neighborHardFitness = KheHardCost(KheSolnCost(soln));
         int neighborSoftFitness = KheSoftCost(KheSolnCost(soln));
         if (neighborHardFitness < bestHardFitness || (neighborHardFitness == bestHardFitness && neighborSoftFitness < bestSoftFitness)) {
@@ -690,8 +1987,10 @@ KHE_SOLN descent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, int it
         } else if (neighborHardFitness > bestHardFitness || neighborSoftFitness > bestSoftFitness) {
             // caso a solucao seja pior que a anterior
             KheTransactionUndo(t); // desfaz o movimento
+            accepted = false;
         }
         KheTransactionDelete(t);
+        telemetry.iteration(soln, neighborhood, accepted);
 
         iter++;
     }
@@ -699,6 +1998,91 @@ KHE_SOLN descent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, int it
     return soln;
 }
 
+// Descida por melhor melhora: a cada rodada avalia todas as trocas que
+// envolvem meets em defeito (em paralelo nas copias de swapPool) e aplica,
+// da melhor para a pior, as trocas melhoras que nao compartilham meets.
+// Como as trocas ainda podem interagir pelos monitores, cada uma so fica
+// se continuar melhorando quando aplicada.
+KHE_SOLN bestDescent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, Config &config) {
+    KHE_COST bestKnownCost = KheSolnCost(bestSoln);
+    vector< int > defects;
+    vector< pair< int, int > > swaps;
+    vector< KHE_COST > costs;
+    vector< int > valid, order, log;
+    vector< char > used;
+
+    int round = 0;
+    bool improved = true;
+    while (improved && config.getRemainingTime() > 0) {
+        defectMeets(soln, defects);
+        defectMeetSwaps(soln, defects, swaps);
+        costs.resize(swaps.size());
+        valid.resize(swaps.size());
+
+        if (swapPool.size() > 0 && swapPool.align(soln)) {
+            int workers = swapPool.size();
+            swapPool.run([&](int id, KHE_SOLN replica) {
+                for (int i = id; i < swaps.size(); i += workers)
+                    costs[i] = evaluateMeetSwap(replica, swaps[i], valid[i]);
+            });
+        } else {
+            for (int i = 0; i < swaps.size(); i++)
+                costs[i] = evaluateMeetSwap(soln, swaps[i], valid[i]);
+        }
+
+        KHE_COST cost = KheSolnCost(soln);
+        order.clear();
+        for (int i = 0; i < swaps.size(); i++)
+            if (valid[i] && isBetterSolution(costs[i], cost))
+                order.push_back(i);
+        stable_sort(order.begin(), order.end(), [&](int a, int b) {
+            return isBetterSolution(costs[a], costs[b]);
+        });
+
+        // as trocas aplicadas ficam num log, reaplicado nas copias na rodada
+        // seguinte em vez de compara-las meet a meet com a solucao
+        uint64_t from = KheSolnAssignHash(soln);
+        KHE_TRANSACTION t = KheTransactionMake(soln);
+        KheTransactionSetLogging(t, swapPool.size() > 0);
+        KheTransactionBegin(t);
+
+        improved = false;
+        used.assign(KheSolnMeetCount(soln), false);
+        for (int k = 0; k < order.size(); k++) {
+            pair< int, int > &swap = swaps[order[k]];
+            if (used[swap.first] || used[swap.second]) continue;
+
+            KHE_COST before = KheSolnCost(soln);
+            KHE_MEET meet1 = KheSolnMeet(soln, swap.first);
+            KHE_MEET meet2 = KheSolnMeet(soln, swap.second);
+            if (!KheMeetSwap(meet1, meet2)) continue;
+            if (!isBetterSolution(soln, before)) {
+                KheMeetSwap(meet1, meet2);
+                continue;
+            }
+            used[swap.first] = used[swap.second] = true;
+            improved = true;
+        }
+
+        KheTransactionEnd(t);
+        if (swapPool.size() > 0 && KheTransactionLogPortable(t)) {
+            log.resize(KheTransactionLogLength(t));
+            KheTransactionLogExport(t, log.data());
+            swapPool.replay(soln, from, log);
+        }
+        KheTransactionDelete(t);
+
+        round++;
+        telemetry.iteration(soln, MEET_SWAP, improved);
+        if (isBetterSolution(soln, bestKnownCost)) {
+            bestKnownCost = KheSolnCost(soln);
+            printToLog(soln, config, MEET_SWAP, round, 0.0);
+        }
+    }
+
+    return soln;
+}
+
 //=====================================================
 // Funcoes utilitarias
 //=====================================================
@@ -712,6 +2096,11 @@ void printToLog(KHE_SOLN soln, Config &config, int neighborhood, int iter, doubl
         printf(" temp: %-3.3lf", temp);
 
     printf("\n");
+
+    if (config.improved)
+        config.improved(soln, config);
+    if (bounds.reached(soln))
+        printf("*** lower bound reached: stopping\n");
 }
 
 bool isBetterSolution(KHE_SOLN solnA, KHE_SOLN solnB) {
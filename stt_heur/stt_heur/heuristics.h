@@ -3,6 +3,8 @@
 
 #include <ctime>
 #include <list>
+#include <map>
+#include <vector>
 
 extern "C" {
 #include "khe/khe.h"
@@ -10,7 +12,7 @@ extern "C" {
 
 #include "config.h"
 
-#define MAX_NEIGHBOR        8
+#define MAX_NEIGHBOR        11
 #define MEET_SWAP           1
 #define TASK_SWAP           2
 #define TASK_RESOURCE_SWAP  3
@@ -18,19 +20,65 @@ extern "C" {
 #define MEET_TIME_CHANGE    5
 #define PERMUT_RESOURCES    6
 #define KEMPE_TIMES         7
-#define MEET_SPLIT          8
-#define MEET_MERGE          9
-#define MEET_UNASSIGN       10
+#define TIME_SLOT_SWAP      8
+#define MEET_SPLIT          9
+#define MEET_MERGE          10
+#define TWO_COLOUR_REASSIGN 11
+#define LNS_STEP            12  // so no log e na telemetria: nao e sorteada
+
+#define MEET_TARGET_DRAWS   4
+
+#define LNS_RESOURCE        0
+#define LNS_DAY             1
+#define LNS_LAYER           2
+#define LNS_DESTROY_COUNT   3
+#define LNS_REPAIR_PASSES   3
 
 using namespace std;
 
+// Movimento candidato da busca tabu (indices na solucao e na instancia)
+class TabuMove {
+public:
+    int neighborhood;
+    int first, second;
+};
+
+// Passo da LNS: operador de destruicao e o recurso (ou grupo de horarios)
+// cuja regiao ele desfaz; seed fixa a ordem e os desempates do reparo
+class LnsMove {
+public:
+    int destroy;
+    int target;
+    unsigned seed;
+};
+
 //--------------------------------------------------------------------------
 
 // Configura movimentos
 void configureMoves(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
 void restartMoves();
+void refreshReplicas(KHE_SOLN soln);
+void releaseMoves();
+
+// Destinos legais de realocacao
+void meetTimeTargets(KHE_SOLN soln, KHE_INSTANCE instance, KHE_MEET meet, vector< int > &times);
+void taskResourceTargets(KHE_SOLN soln, KHE_INSTANCE instance, KHE_TASK task, vector< int > &resources);
+void syncMeetTargets(KHE_SOLN soln, KHE_INSTANCE instance);
+void syncTaskTargets(KHE_SOLN soln, KHE_INSTANCE instance);
+pair< int, int > getMeetTimeMove(KHE_SOLN soln, KHE_INSTANCE instance);
+int getMeetTarget(KHE_SOLN soln, KHE_MEET meet, int i);
+pair< int, int > getTaskResourceMove(KHE_SOLN soln, KHE_INSTANCE instance);
+
+// Divisao e juncao de meets
+void syncMeetSwaps(KHE_SOLN soln);
+void syncMergeEvents(KHE_SOLN soln, KHE_INSTANCE instance);
+int getSplitMeet(KHE_SOLN soln);
+pair< int, int > getMergeMove(KHE_SOLN soln, KHE_INSTANCE instance);
+bool splitMeet(KHE_SOLN soln, KHE_INSTANCE instance, KHE_MEET meet);
+bool mergeMeets(KHE_SOLN soln, KHE_MEET meet1, KHE_MEET meet2);
 
 // Gera vizinhos
+bool neighborhoodEnabled(int neighborhood);
 int randomNeighborhood();
 bool generateNeighbor(KHE_SOLN soln, KHE_INSTANCE instance, int &neighborhood);
 
@@ -40,13 +88,55 @@ KHE_SOLN permutResource(KHE_SOLN soln, KHE_INSTANCE instance, KHE_RESOURCE resou
 // Vizinhanca Kempe
 list< int > bfsConflictsGraph(map< int, map< int, int > > &G, map< int, int > &v, int last, int level);
 list< int > generateConflictsGraph(KHE_SOLN soln, KHE_INSTANCE instance, KHE_TIME time1, KHE_TIME time2);
+KHE_COST evaluateKempeChain(KHE_SOLN soln, list< int > &chain, KHE_TIME time1, KHE_TIME time2);
+
+// Vizinhanca Slot
+bool canMoveSlotMeet(KHE_SOLN soln, KHE_MEET meet, KHE_TIME time);
+bool collectSlotMeets(KHE_SOLN soln, KHE_TIME time, KHE_TIME newTime, vector< KHE_MEET > &meets);
+bool swapTimeSlots(KHE_SOLN soln, KHE_TIME time1, KHE_TIME time2);
+
+// Trocas de meets em defeito
+void markEventMeets(KHE_SOLN soln, KHE_EVENT event, vector< char > &marked);
+void markResourceMeets(KHE_SOLN soln, KHE_RESOURCE resource, vector< char > &marked);
+void defectMeets(KHE_SOLN soln, vector< int > &meets);
+void defectMeetSwaps(KHE_SOLN soln, vector< int > &defects, vector< pair< int, int > > &swaps);
+KHE_COST evaluateMeetSwap(KHE_SOLN soln, pair< int, int > &swap, int &valid);
+
+// Reatribuicao de recursos em duas cores
+void defectResources(KHE_SOLN soln, vector< int > &resources);
+void sampleResourcePairs(KHE_SOLN soln, KHE_INSTANCE instance, int count, vector< pair< int, int > > &pairs);
+KHE_COST evaluateTwoColour(KHE_SOLN soln, KHE_INSTANCE instance, pair< int, int > &resources, int &valid);
+bool twoColourReassign(KHE_SOLN soln, KHE_INSTANCE instance);
 
 // Heuristicas
 KHE_SOLN descent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, int iterMax, Config &config);
+KHE_SOLN bestDescent(KHE_SOLN soln, KHE_SOLN bestSoln, KHE_INSTANCE instance, Config &config);
+bool calibrateAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
 KHE_SOLN simulatedAnnealing(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
 KHE_SOLN ils(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
 KHE_SOLN vns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
 KHE_SOLN rvns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+KHE_SOLN tabuSearch(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+KHE_SOLN lns(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+
+// Pool de elite e path relinking
+KHE_SOLN relinkElites(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+
+// Busca tabu
+TabuMove sampleTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+bool applyTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move);
+KHE_COST evaluateTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move, int &valid);
+void tabuAttributes(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move, bool after, vector< pair< int, int > > &meetAttrs, vector< pair< int, int > > &taskAttrs);
+bool isTabuMove(KHE_SOLN soln, KHE_INSTANCE instance, TabuMove &move, vector< int > &meetTabu, vector< int > &taskTabu, int iter);
+
+// Busca em vizinhanca grande (LNS)
+void lnsPrepare(KHE_SOLN soln);
+LnsMove sampleLnsMove(KHE_INSTANCE instance, vector< int > &days);
+void lnsRegion(KHE_SOLN soln, KHE_INSTANCE instance, LnsMove &move, Config &config, vector< KHE_MEET > &meets, vector< KHE_TASK > &tasks);
+void lnsInsert(KHE_SOLN soln, KHE_NODE root, vector< KHE_MEET > &meets, unsigned seed);
+void lnsReinsert(KHE_SOLN soln, KHE_NODE root, vector< KHE_MEET > &meets);
+bool applyLnsMove(KHE_SOLN soln, KHE_INSTANCE instance, LnsMove &move, Config &config, KHE_TRANSACTION t);
+KHE_COST evaluateLnsMove(KHE_SOLN soln, KHE_INSTANCE instance, LnsMove &move, Config &config, int &valid);
 
 // Funcoes auxiliares
 void printToLog(KHE_SOLN soln, Config &config, int neighborhood, int iter, double temp);
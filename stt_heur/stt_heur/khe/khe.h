@@ -490,6 +490,7 @@ extern bool KheArchiveRetrieveSolnGroup(KHE_ARCHIVE archive, char *id,
 /* 2.2 solution groups */
 extern bool KheSolnGroupMake(KHE_ARCHIVE archive, char *id,
   KHE_SOLN_GROUP_METADATA md, KHE_SOLN_GROUP *soln_group);
+extern void KheSolnGroupDelete(KHE_SOLN_GROUP soln_group);
 extern void KheSolnGroupSetBack(KHE_SOLN_GROUP soln_group, void *back);
 extern void *KheSolnGroupBack(KHE_SOLN_GROUP soln_group);
 
@@ -515,6 +516,8 @@ extern bool KheArchiveRead(FILE *fp, KHE_ARCHIVE *archive,
   bool infer_resource_partitions, KML_ERROR *ke);
 extern bool KheArchiveReadFromString(char *str, KHE_ARCHIVE *archive,
   bool infer_resource_partitions, KML_ERROR *ke);
+extern bool KheArchiveReadSolnGroups(KHE_ARCHIVE archive, FILE *fp,
+  KML_ERROR *ke);
 extern bool KheArchiveWrite(KHE_ARCHIVE archive, bool with_reports, FILE *fp);
 
 
@@ -1461,6 +1464,13 @@ extern void KheSolnSetVisitNum(KHE_SOLN soln, int num);
 extern int KheSolnVisitNum(KHE_SOLN soln);
 extern void KheSolnNewVisit(KHE_SOLN soln);
 
+/* 4.6.1 Assignment hashing */
+extern uint64_t KheSolnAssignHash(KHE_SOLN soln);
+
+/* 4.6.2 Batching */
+extern void KheSolnBeginBatch(KHE_SOLN soln);
+extern void KheSolnEndBatch(KHE_SOLN soln);
+
 /* 4.7 Meets */
 extern KHE_MEET KheMeetMake(KHE_SOLN soln, int duration, KHE_EVENT e);
 extern void KheMeetDelete(KHE_MEET meet);
@@ -1679,6 +1689,12 @@ extern void KheTransactionEnd(KHE_TRANSACTION t);
 extern void KheTransactionUndo(KHE_TRANSACTION t);
 extern void KheTransactionRedo(KHE_TRANSACTION t);
 extern void KheTransactionCopy(KHE_TRANSACTION src_t, KHE_TRANSACTION dst_t);
+extern void KheTransactionSetLogging(KHE_TRANSACTION t, bool logging);
+extern bool KheTransactionLogPortable(KHE_TRANSACTION t);
+extern int KheTransactionLogLength(KHE_TRANSACTION t);
+extern void KheTransactionLogExport(KHE_TRANSACTION t, int *log);
+extern bool KheSolnReplayLog(KHE_SOLN soln, int *log, int len);
+extern bool KheSolnTransactionOpen(KHE_SOLN soln);
 extern void KheTransactionDebug(KHE_TRANSACTION t, int verbosity,
   int indent, FILE *fp);
 
@@ -2064,6 +2080,12 @@ extern int KheTimetableMonitorTimeMeetCount(KHE_TIMETABLE_MONITOR tt,
   KHE_TIME time);
 extern KHE_MEET KheTimetableMonitorTimeMeet(KHE_TIMETABLE_MONITOR tt,
   KHE_TIME time, int i);
+extern bool KheTimetableMonitorTimesAreFree(KHE_TIMETABLE_MONITOR tm,
+  KHE_TIME time, int durn);
+extern int KheTimetableMonitorClashCount(KHE_TIMETABLE_MONITOR tm1,
+  KHE_TIMETABLE_MONITOR tm2);
+extern int KheTimetableMonitorsFreeTimes(KHE_TIMETABLE_MONITOR *tms,
+  int count, int durn, int *time_indexes);
 extern void KheTimetableMonitorPrintTimetable(KHE_TIMETABLE_MONITOR tm,
   int cell_width, int indent, FILE *fp);
 
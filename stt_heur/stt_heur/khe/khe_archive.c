@@ -239,6 +239,28 @@ void KheArchiveAddSolnGroup(KHE_ARCHIVE archive, KHE_SOLN_GROUP soln_group)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheArchiveDeleteSolnGroup(KHE_ARCHIVE archive,                      */
+/*    KHE_SOLN_GROUP soln_group)                                             */
+/*                                                                           */
+/*  Delete soln_group from archive.                                          */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheArchiveDeleteSolnGroup(KHE_ARCHIVE archive, KHE_SOLN_GROUP soln_group)
+{
+  int pos;  KHE_SOLN_GROUP sg;
+  if( !MArrayContains(archive->soln_group_array, soln_group, &pos) )
+    MAssert(false, "KheArchiveDeleteSolnGroup: soln_group not present");
+  MArrayRemove(archive->soln_group_array, pos);
+  if( KheSolnGroupId(soln_group) != NULL &&
+      MTableRetrieve(archive->soln_group_table, KheSolnGroupId(soln_group),
+	&sg, &pos) )
+    MTableDelete(archive->soln_group_table, pos);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  int KheArchiveSolnGroupCount(KHE_ARCHIVE archive)                        */
@@ -395,6 +417,81 @@ bool KheArchiveReadFromString(char *str, KHE_ARCHIVE *archive,
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheArchiveReadSolnGroups(KHE_ARCHIVE archive, FILE *fp,             */
+/*    KML_ERROR *ke)                                                         */
+/*                                                                           */
+/*  Read solution groups from fp and add them to archive.  The file may      */
+/*  hold a whole archive (whose instances are ignored), a <SolutionGroups>   */
+/*  element, or a single <SolutionGroup> as written by KheSolnGroupWrite.    */
+/*                                                                           */
+/*  Solutions for instances not in archive are dropped, and groups whose     */
+/*  Id is already used in archive are skipped, so that the solutions for     */
+/*  archive can be taken from a larger archive, or from the file archive     */
+/*  itself was read from.                                                    */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheArchiveReadSolnGroups(KHE_ARCHIVE archive, FILE *fp, KML_ERROR *ke)
+{
+  KML_ELT root_elt, soln_groups_elt, soln_group_elt, soln_elt;
+  KHE_SOLN_GROUP soln_group;  KHE_INSTANCE ins;  int i, j, count;
+
+  /* find the solution groups */
+  if( !KmlRead(fp, &root_elt, ke) )
+    return false;
+  if( strcmp(KmlLabel(root_elt), "SolutionGroup") == 0 )
+    soln_groups_elt = NULL;
+  else if( strcmp(KmlLabel(root_elt), "SolutionGroups") == 0 )
+    soln_groups_elt = root_elt;
+  else if( strcmp(KmlLabel(root_elt), "HighSchoolTimetableArchive") == 0 )
+  {
+    if( !KmlContainsChild(root_elt, "SolutionGroups", &soln_groups_elt) )
+      return KmlErrorMake(ke, KmlLineNum(root_elt), KmlColNum(root_elt),
+	"archive has no <SolutionGroups>");
+  }
+  else
+    return KmlErrorMake(ke, KmlLineNum(root_elt), KmlColNum(root_elt),
+      "file does not begin with <SolutionGroup> or <SolutionGroups> "
+      "or <HighSchoolTimetableArchive>");
+
+  /* build and add those solution groups that are new to archive */
+  count = (soln_groups_elt == NULL ? 1 : KmlChildCount(soln_groups_elt));
+  for( i = 0;  i < count;  i++ )
+  {
+    soln_group_elt = (soln_groups_elt == NULL ? root_elt :
+      KmlChild(soln_groups_elt, i));
+    if( strcmp(KmlLabel(soln_group_elt), "SolutionGroup") != 0 )
+      return KmlErrorMake(ke, KmlLineNum(soln_group_elt),
+	KmlColNum(soln_group_elt), "<%s> where <SolutionGroup> expected",
+	KmlLabel(soln_group_elt));
+    if( KmlAttributeCount(soln_group_elt) == 1 &&
+	KheArchiveRetrieveSolnGroup(archive,
+	  KmlAttributeValue(soln_group_elt, 0), &soln_group) )
+      continue;
+    for( j = KmlChildCount(soln_group_elt) - 1;  j >= 0;  j-- )
+    {
+      soln_elt = KmlChild(soln_group_elt, j);
+      if( strcmp(KmlLabel(soln_elt), "Solution") == 0 &&
+	  KmlAttributeCount(soln_elt) == 1 &&
+	  !KheArchiveRetrieveInstance(archive, KmlAttributeValue(soln_elt, 0),
+	    &ins) )
+      {
+	KmlDeleteChild(soln_group_elt, soln_elt);
+	KmlFree(soln_elt, true, true, true, true);
+      }
+    }
+    if( !KheSolnGroupMakeFromKml(soln_group_elt, archive, ke) )
+      return false;
+  }
+
+  KmlFree(root_elt, true, true, true, true);
+  *ke = NULL;
+  return true;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  bool KheArchiveWrite(KHE_ARCHIVE archive, bool with_reports, FILE *fp)   */
@@ -39,17 +39,19 @@
 struct khe_assign_time_monitor_rec {
 
   /* inherited from KHE_MONITOR */
-  KHE_SOLN			soln;			/* encl. solution    */
-  int				index_in_soln;		/* index in soln     */
+  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  KHE_COST			cost;			/* current cost      */
+  int				defect_index;		/* defect index      */
   unsigned char			tag;			/* tag field         */
   bool				attached;		/* true if attached  */
-  void				*back;			/* back pointer      */
-  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  bool				batched;		/* change deferred   */
+  bool				dirty;			/* awaiting flush    */
   int				parent_index;		/* index in parent   */
-  int				defect_index;		/* defect index      */
-  int				trace_num;		/* trace visit num   */
+  int				index_in_soln;		/* index in soln     */
+  KHE_SOLN			soln;			/* encl. solution    */
+  void				*back;			/* back pointer      */
   KHE_COST			trace_cost;		/* at start of trace */
-  KHE_COST			cost;			/* current cost      */
+  int				trace_num;		/* trace visit num   */
 
   /* specific to KHE_ASSIGN_TIME_MONITOR */
   int				deviation;		/* unassigned durn   */
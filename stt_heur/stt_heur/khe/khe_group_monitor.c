@@ -42,17 +42,19 @@
 struct khe_group_monitor_rec {
 
   /* inherited from KHE_MONITOR */
-  KHE_SOLN			soln;			/* encl. solution    */
-  int				index_in_soln;		/* index in soln     */
+  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  KHE_COST			cost;			/* current cost      */
+  int				defect_index;		/* defect index      */
   unsigned char			tag;			/* tag field         */
   bool				attached;		/* true if attached  */
-  void				*back;			/* back pointer      */
-  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  bool				batched;		/* change deferred   */
+  bool				dirty;			/* awaiting flush    */
   int				parent_index;		/* index in parent   */
-  int				defect_index;		/* defect index      */
-  int				trace_num;		/* trace visit num   */
+  int				index_in_soln;		/* index in soln     */
+  KHE_SOLN			soln;			/* encl. solution    */
+  void				*back;			/* back pointer      */
   KHE_COST			trace_cost;		/* at start of trace */
-  KHE_COST			cost;			/* current cost      */
+  int				trace_num;		/* trace visit num   */
 
   /* specific to KHE_GROUP_MONITOR */
   ARRAY_KHE_MONITOR		child_monitors;		/* child monitors    */
@@ -118,6 +120,7 @@ void KheGroupMonitorDelete(KHE_GROUP_MONITOR gm)
 {
   MAssert(gm != (KHE_GROUP_MONITOR) gm->soln,
     "KheGroupMonitorDelete:  gm is soln");
+  KheSolnBatchFlush(gm->soln);
   MAssert(MArraySize(gm->traces) == 0,
     "KheGroupMonitorDelete:  gm is currently being traced");
   while( MArraySize(gm->child_monitors) > 0 )
@@ -418,6 +421,7 @@ void KheGroupMonitorAddChildMonitor(KHE_GROUP_MONITOR gm, KHE_MONITOR m)
 {
   /* make sure m's cost is up to date (IMPORTANT - this is a nasty bug fix!) */
   KheMonitorCost(m);
+  KheSolnBatchFlush(gm->soln);
 
   /* remove m from any parent it has now */
   if( KheMonitorParentMonitor(m) != NULL )
@@ -450,6 +454,9 @@ void KheGroupMonitorDeleteChildMonitor(KHE_GROUP_MONITOR gm, KHE_MONITOR m)
 {
   KHE_MONITOR m2;
 
+  /* bring gm's view of m's cost up to date */
+  KheSolnBatchFlush(gm->soln);
+
   /* change gm's cost and remove m from defects, if m has non-zero cost */
   if( KheMonitorCost(m) > 0 )
     KheGroupMonitorChangeCost(gm, m, KheMonitorCost(m), 0);
@@ -506,6 +513,7 @@ KHE_MONITOR KheGroupMonitorChildMonitor(KHE_GROUP_MONITOR gm, int i)
 int KheGroupMonitorDefectCount(KHE_GROUP_MONITOR gm)
 {
   KheSolnMatchingUpdate(gm->soln);
+  KheSolnBatchFlush(gm->soln);
   return MArraySize(gm->defects);
 }
 
@@ -521,6 +529,7 @@ int KheGroupMonitorDefectCount(KHE_GROUP_MONITOR gm)
 KHE_MONITOR KheGroupMonitorDefect(KHE_GROUP_MONITOR gm, int i)
 {
   KheSolnMatchingUpdate(gm->soln);
+  KheSolnBatchFlush(gm->soln);
   return MArrayGet(gm->defects, i);
 }
 
@@ -572,6 +581,7 @@ void KheGroupMonitorDefectSort(KHE_GROUP_MONITOR gm)
 void KheGroupMonitorCopyDefects(KHE_GROUP_MONITOR gm)
 { 
   int i;
+  KheSolnBatchFlush(gm->soln);
   MArrayClear(gm->defects_copy);
   MArrayAppend(gm->defects_copy, gm->defects, i);
 }
@@ -620,6 +630,7 @@ KHE_COST KheGroupMonitorCostByType(KHE_GROUP_MONITOR gm, KHE_MONITOR_TAG tag,
 {
   KHE_COST res;  int i, dc;  KHE_MONITOR m;
   res = 0;  *defect_count = 0;
+  KheSolnBatchFlush(gm->soln);
   if( tag == KHE_GROUP_MONITOR_TAG )
     return res;
   KheSolnMatchingUpdate(gm->soln);
@@ -737,6 +748,7 @@ void KheGroupMonitorDetach(KHE_GROUP_MONITOR gm)
 
 void KheGroupMonitorBeginTrace(KHE_GROUP_MONITOR gm, KHE_TRACE t)
 {
+  KheSolnBatchFlush(gm->soln);
   MArrayAddLast(gm->traces, t);
 }
 
@@ -752,6 +764,7 @@ void KheGroupMonitorBeginTrace(KHE_GROUP_MONITOR gm, KHE_TRACE t)
 void KheGroupMonitorEndTrace(KHE_GROUP_MONITOR gm, KHE_TRACE t)
 {
   int pos;
+  KheSolnBatchFlush(gm->soln);
   if( !MArrayContains(gm->traces, t, &pos) )
     MAssert(false, "KheGroupMonitorEndTrace internal error");
   MArrayRemove(gm->traces, pos);
@@ -797,8 +810,13 @@ void KheGroupMonitorChangeCost(KHE_GROUP_MONITOR gm, KHE_MONITOR m,
   else if( new_cost == 0 )
     KheGroupMonitorDeleteDefect(gm, m);
   if( gm->parent_monitor != NULL )
-    KheGroupMonitorChangeCost(gm->parent_monitor, (KHE_MONITOR) gm,
-      gm->cost - delta_cost, gm->cost);
+  {
+    if( KheSolnBatching(gm->soln) )
+      KheMonitorDeferCostChange((KHE_MONITOR) gm, gm->cost - delta_cost);
+    else
+      KheGroupMonitorChangeCost(gm->parent_monitor, (KHE_MONITOR) gm,
+	gm->cost - delta_cost, gm->cost);
+  }
   if( DEBUG2 )
     fprintf(stderr, "] KheGroupMonitorChangeCost returning\n");
 }
@@ -179,6 +179,8 @@ extern void KheArchiveAddInstance(KHE_ARCHIVE archive, KHE_INSTANCE ins);
 /* solution groups */
 extern void KheArchiveAddSolnGroup(KHE_ARCHIVE archive,
   KHE_SOLN_GROUP soln_group);
+extern void KheArchiveDeleteSolnGroup(KHE_ARCHIVE archive,
+  KHE_SOLN_GROUP soln_group);
 
 
 /*****************************************************************************/
@@ -217,6 +219,7 @@ extern bool KheSolnGroupWrite(KHE_SOLN_GROUP soln_group, bool with_reports,
 /*****************************************************************************/
 
 /* reading and writing */
+extern void KheSolnGroupMetaDataDelete(KHE_SOLN_GROUP_METADATA md);
 extern bool KheSolnGroupMetaDataMakeFromKml(KML_ELT md_elt,
   KHE_SOLN_GROUP soln_group, KML_ERROR *ke);
 extern bool KheSolnGroupMetaDataWrite(KHE_SOLN_GROUP_METADATA md, KML_FILE kf);
@@ -915,11 +918,25 @@ extern void KheSolnAddTransactionToFreeList(KHE_SOLN soln, KHE_TRANSACTION t);
 extern void KheSolnBeginTransaction(KHE_SOLN soln, KHE_TRANSACTION t);
 extern void KheSolnEndTransaction(KHE_SOLN soln, KHE_TRANSACTION t);
 
+/* batching */
+extern bool KheSolnBatching(KHE_SOLN soln);
+extern void KheSolnBatchAddMonitor(KHE_SOLN soln, KHE_MONITOR m,
+  KHE_COST reported_cost);
+extern void KheSolnBatchFlush(KHE_SOLN soln);
+
+/* assignment hashing */
+extern void KheSolnAssignHashReset(KHE_SOLN soln);
+extern void KheSolnAssignHashToggleMeet(KHE_SOLN soln, KHE_MEET meet);
+extern void KheSolnAssignHashToggleTask(KHE_SOLN soln, KHE_TASK task);
+
 /* transaction operation loading */
 extern void KheSolnOpMeetMake(KHE_SOLN soln, KHE_MEET res);
 extern void KheSolnOpMeetDelete(KHE_SOLN soln);
 extern void KheSolnOpMeetSplit(KHE_SOLN soln, KHE_MEET meet1, KHE_MEET meet2);
-extern void KheSolnOpMeetMerge(KHE_SOLN soln);
+extern void KheSolnOpMeetMerge(KHE_SOLN soln, KHE_MEET meet1,
+  KHE_MEET meet2);
+extern void KheSolnOpMeetMergeTask(KHE_SOLN soln, KHE_TASK task1,
+  KHE_TASK task2);
 extern void KheSolnOpMeetAssign(KHE_SOLN soln, KHE_MEET meet,
   KHE_MEET target_meet, int target_offset);
 extern void KheSolnOpMeetUnAssign(KHE_SOLN soln, KHE_MEET meet,
@@ -954,6 +971,7 @@ extern void KheSolnDeleteMonitor(KHE_SOLN soln, KHE_MONITOR m);
 /* meets */
 extern void KheSolnAddMeet(KHE_SOLN soln, KHE_MEET meet, int *index);
 extern void KheSolnDeleteMeet(KHE_SOLN soln, KHE_MEET meet);
+extern void KheSolnSwapMeets(KHE_SOLN soln, int index1, int index2);
 
 /* cycle meets */
 extern void KheSolnCycleMeetMerge(KHE_SOLN soln, KHE_MEET meet1,
@@ -968,6 +986,7 @@ extern void KheSolnDeleteNode(KHE_SOLN soln, KHE_NODE node);
 /* tasks */
 extern void KheSolnAddTask(KHE_SOLN soln, KHE_TASK task, int *index_in_soln);
 extern void KheSolnDeleteTask(KHE_SOLN soln, KHE_TASK task);
+extern void KheSolnSwapTasks(KHE_SOLN soln, int index1, int index2);
 extern KHE_TASK KheSolnGetTaskFromFreeList(KHE_SOLN soln);
 extern void KheSolnAddTaskToFreeList(KHE_SOLN soln, KHE_TASK task);
 
@@ -1230,7 +1249,10 @@ extern void KheTransactionOpMeetMake(KHE_TRANSACTION t, KHE_MEET res);
 extern void KheTransactionOpMeetDelete(KHE_TRANSACTION t);
 extern void KheTransactionOpMeetSplit(KHE_TRANSACTION t,
   KHE_MEET meet1, KHE_MEET meet2);
-extern void KheTransactionOpMeetMerge(KHE_TRANSACTION t);
+extern void KheTransactionOpMeetMerge(KHE_TRANSACTION t,
+  KHE_MEET meet1, KHE_MEET meet2);
+extern void KheTransactionOpMeetMergeTask(KHE_TRANSACTION t,
+  KHE_TASK task1, KHE_TASK task2);
 extern void KheTransactionOpMeetAssign(KHE_TRANSACTION t,
   KHE_MEET meet, KHE_MEET target_meet, int target_offset);
 extern void KheTransactionOpMeetUnAssign(KHE_TRANSACTION t,
@@ -1252,6 +1274,10 @@ extern void KheTransactionOpNodeAddParent(KHE_TRANSACTION t,
   KHE_NODE child_node, KHE_NODE parent_node);
 extern void KheTransactionOpNodeDeleteParent(KHE_TRANSACTION t,
   KHE_NODE child_node, KHE_NODE parent_node);
+extern void KheTransactionLogMeetSwap(KHE_TRANSACTION t, int index1,
+  int index2);
+extern void KheTransactionLogTaskSwap(KHE_TRANSACTION t, int index1,
+  int index2);
 
 /* cost */
 /* ***
@@ -1475,6 +1501,10 @@ extern void KheTraceChangeCost(KHE_TRACE t, KHE_MONITOR m, KHE_COST old_cost);
 /* construction and query */
 /* extern void KheMonitorCheck(KHE_MONITOR m); */
 extern void KheMonitorChangeCost(KHE_MONITOR m, KHE_COST new_cost);
+extern void KheMonitorDeferCostChange(KHE_MONITOR m, KHE_COST reported_cost);
+extern void KheMonitorFlushCostChange(KHE_MONITOR m, KHE_COST reported_cost);
+extern bool KheMonitorDirty(KHE_MONITOR m);
+extern void KheMonitorSetDirty(KHE_MONITOR m, bool dirty);
 extern void KheMonitorInitCommonFields(KHE_MONITOR m, KHE_SOLN soln,
   KHE_MONITOR_TAG tag);
 extern void KheMonitorCopyCommonFields(KHE_MONITOR copy, KHE_MONITOR orig);
@@ -372,6 +372,70 @@ bool LSetDisjoint(LSET s1, LSET s2)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  int LSetIntersectionCount(LSET s1, LSET s2)                              */
+/*                                                                           */
+/*  Return the number of elements that s1 and s2 have in common.  This       */
+/*  works a word at a time, counting the bits of each word of s1 & s2.       */
+/*                                                                           */
+/*****************************************************************************/
+
+static int LSetWordCount(unsigned int word)
+{
+#ifdef __GNUC__
+  return __builtin_popcount(word);
+#else
+  int res;
+  for( res = 0;  word != 0;  res++ )
+    word &= word - 1;
+  return res;
+#endif
+}
+
+int LSetIntersectionCount(LSET s1, LSET s2)
+{
+  int i, len, res;
+  len = s1->length <= s2->length ? s1->length : s2->length;
+  res = 0;
+  for( i = 0;  i < len;  i++ )
+    if( s1->elems[i] & s2->elems[i] )
+      res += LSetWordCount(s1->elems[i] & s2->elems[i]);
+  return res;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool LSetIntervalDisjoint(LSET s, unsigned int first, unsigned int last) */
+/*                                                                           */
+/*  Return true if s contains no element i such that first <= i <= last.    */
+/*  Each word overlapping the interval is tested against a mask, so the     */
+/*  cost does not depend on the length of the interval.                      */
+/*                                                                           */
+/*****************************************************************************/
+
+bool LSetIntervalDisjoint(LSET s, unsigned int first, unsigned int last)
+{
+  int word, first_word, last_word;  unsigned int mask;
+  first_word = first / INT_BIT;
+  last_word = last / INT_BIT;
+  if( last_word >= s->length )
+    last_word = s->length - 1;
+  for( word = first_word;  word <= last_word;  word++ )
+  {
+    mask = ~0u;
+    if( word == first_word )
+      mask &= ~0u << (first % INT_BIT);
+    if( word == (int) (last / INT_BIT) )
+      mask &= ~0u >> (INT_BIT - 1 - last % INT_BIT);
+    if( s->elems[word] & mask )
+      return false;
+  }
+  return true;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  bool LSetDifferenceDisjoint(LSET s1a, LSET s1b, LSET s2)                 */
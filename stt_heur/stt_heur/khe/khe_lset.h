@@ -37,6 +37,9 @@ extern bool LSetEmpty(LSET s);
 extern bool LSetEqual(LSET s1, LSET s2);
 extern bool LSetSubset(LSET s1, LSET s2);
 extern bool LSetDisjoint(LSET s1, LSET s2);
+extern int LSetIntersectionCount(LSET s1, LSET s2);
+extern bool LSetIntervalDisjoint(LSET s, unsigned int first,
+  unsigned int last);
 /* extern bool LSetDifferenceDisjoint(LSET s1a, LSET s1b, LSET s2); */
 /* extern bool LSetIntersectionEqual(LSET s1a, LSET s1b, LSET s2); */
 extern bool LSetContains(LSET s, unsigned int i);
@@ -1467,12 +1467,13 @@ bool KheMeetMerge(KHE_MEET meet1, KHE_MEET meet2, KHE_MEET *meet)
   }
 
   /* inform soln that this is happening */
-  KheSolnOpMeetMerge(meet1->soln);
+  KheSolnOpMeetMerge(meet1->soln, meet1, meet2);
 
   /* merge the tasks of meet2 (already reordered) into those of meet1 */
   MArrayForEach(meet1->tasks, &task1, &i)
   {
     task2 = MArrayGet(meet2->tasks, i);
+    KheSolnOpMeetMergeTask(meet1->soln, task1, task2);
     KheTaskMerge(task1, task2);
   }
   MArrayClear(meet2->tasks);
@@ -1532,9 +1533,11 @@ bool KheMeetMerge(KHE_MEET meet1, KHE_MEET meet2, KHE_MEET *meet)
     }
   }
 
-  /* get rid of meet2 */
+  /* get rid of meet2; it and its tasks were deleted while still assigned, */
+  /* and their children were retargeted, so rehash as after a split */
   KheSolnDeleteMeet(meet1->soln, meet2);
   KheMeetFree(meet2);
+  KheSolnAssignHashReset(meet1->soln);
 
   /* return meet1 */
   /* KheMeetCheckAsstInvt(meet1); */
@@ -54,20 +54,45 @@
 /*  trace during which the cost of the monitor changed, and m->trace_cost    */
 /*  is the cost of m at the start of that trace.                             */
 /*                                                                           */
+/*  Batching                                                                 */
+/*  --------                                                                 */
+/*                                                                           */
+/*  While soln is batching (see KheSolnBeginBatch), a change to the cost of  */
+/*  m is not passed to m->parent_monitor straight away.  Instead m->batched  */
+/*  is set and m is added to soln's batch, along with the cost its parent    */
+/*  last saw; the parent is told once, when the batch is flushed.            */
+/*                                                                           */
+/*  Dirty flag                                                               */
+/*  ----------                                                               */
+/*                                                                           */
+/*  m->dirty is set while m is on the dirty list of a timetable monitor,     */
+/*  awaiting a flush, so that the list can be kept free of duplicates        */
+/*  without searching it.                                                    */
+/*                                                                           */
+/*  Field order                                                              */
+/*  -----------                                                              */
+/*                                                                           */
+/*  The fields read when a cost change propagates upwards (parent_monitor,   */
+/*  cost, defect_index, and tag for dispatch) come first, so that they share */
+/*  a cache line; the fields used only when building, copying or tracing     */
+/*  follow.  Every monitor type repeats these fields in this order.          */
+/*                                                                           */
 /*****************************************************************************/
 
 struct khe_monitor_rec {
-  KHE_SOLN			soln;			/* encl. solution    */
-  int				index_in_soln;		/* index in soln     */
+  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  KHE_COST			cost;			/* current cost      */
+  int				defect_index;		/* defect index      */
   unsigned char			tag;			/* tag field         */
   bool				attached;		/* true if attached  */
-  void				*back;			/* back pointer      */
-  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  bool				batched;		/* change deferred   */
+  bool				dirty;			/* awaiting flush    */
   int				parent_index;		/* index in parent   */
-  int				defect_index;		/* defect index      */
-  int				trace_num;		/* trace visit num   */
+  int				index_in_soln;		/* index in soln     */
+  KHE_SOLN			soln;			/* encl. solution    */
+  void				*back;			/* back pointer      */
   KHE_COST			trace_cost;		/* at start of trace */
-  KHE_COST			cost;			/* current cost      */
+  int				trace_num;		/* trace visit num   */
 };
 
 
@@ -177,7 +202,10 @@ KHE_COST KheMonitorCost(KHE_MONITOR m)
   if( m->tag == KHE_GROUP_MONITOR_TAG ||
       m->tag == KHE_ORDINARY_DEMAND_MONITOR_TAG ||
       m->tag == KHE_WORKLOAD_DEMAND_MONITOR_TAG )
+  {
     KheSolnMatchingUpdate(KheMonitorSoln(m));
+    KheSolnBatchFlush(KheMonitorSoln(m));
+  }
   return m->cost;
 }
 
@@ -301,13 +329,75 @@ void KheMonitorChangeCost(KHE_MONITOR m, KHE_COST new_cost)
   {
     /* KheMonitorCheck(m); */
     if( m->parent_monitor != NULL )
-      KheGroupMonitorChangeCost(m->parent_monitor, m, m->cost, new_cost);
+    {
+      if( KheSolnBatching(m->soln) )
+	KheMonitorDeferCostChange(m, m->cost);
+      else
+	KheGroupMonitorChangeCost(m->parent_monitor, m, m->cost, new_cost);
+    }
     m->cost = new_cost;
     /* KheMonitorCheck(m); */
   }
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheMonitorDeferCostChange(KHE_MONITOR m, KHE_COST reported_cost)    */
+/*                                                                           */
+/*  Soln is batching, and the cost of m is about to change.  Unless that     */
+/*  has already happened in this batch, add m to soln's batch, remembering   */
+/*  reported_cost, the cost of m as its parent currently has it.             */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheMonitorDeferCostChange(KHE_MONITOR m, KHE_COST reported_cost)
+{
+  if( !m->batched )
+  {
+    m->batched = true;
+    KheSolnBatchAddMonitor(m->soln, m, reported_cost);
+  }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheMonitorFlushCostChange(KHE_MONITOR m, KHE_COST reported_cost)    */
+/*                                                                           */
+/*  Called when soln's batch is flushed:  tell m's parent that the cost of   */
+/*  m has changed from reported_cost to its current value, if it has.        */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheMonitorFlushCostChange(KHE_MONITOR m, KHE_COST reported_cost)
+{
+  m->batched = false;
+  if( m->cost != reported_cost && m->parent_monitor != NULL )
+    KheGroupMonitorChangeCost(m->parent_monitor, m, reported_cost, m->cost);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheMonitorDirty(KHE_MONITOR m)                                      */
+/*  void KheMonitorSetDirty(KHE_MONITOR m, bool dirty)                       */
+/*                                                                           */
+/*  Get and set the dirty flag of m.                                         */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheMonitorDirty(KHE_MONITOR m)
+{
+  return m->dirty;
+}
+
+void KheMonitorSetDirty(KHE_MONITOR m, bool dirty)
+{
+  m->dirty = dirty;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheMonitorInitCommonFields(KHE_MONITOR m, KHE_SOLN soln,            */
@@ -324,6 +414,8 @@ void KheMonitorInitCommonFields(KHE_MONITOR m, KHE_SOLN soln,
   KheSolnAddMonitor(soln, m, &m->index_in_soln);
   m->tag = tag;
   m->attached = false;
+  m->batched = false;
+  m->dirty = false;
   m->back = NULL;
   m->parent_monitor = NULL;
   m->parent_index = -1;
@@ -348,6 +440,8 @@ void KheMonitorCopyCommonFields(KHE_MONITOR copy, KHE_MONITOR orig)
   copy->index_in_soln = orig->index_in_soln;
   copy->tag = orig->tag;
   copy->attached = orig->attached;
+  copy->batched = false;
+  copy->dirty = false;
   copy->back = orig->back;
   copy->parent_monitor = orig->parent_monitor == NULL ? NULL :
     KheGroupMonitorCopyPhase1(orig->parent_monitor);  /* does soln correctly */
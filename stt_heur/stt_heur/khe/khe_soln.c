@@ -59,17 +59,19 @@
 struct khe_soln_rec {
 
   /* inherited from KHE_GROUP_MONITOR */
-  KHE_SOLN			soln;			/* encl. solution    */
-  int				index_in_soln;		/* not used here     */
+  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  KHE_COST			cost;			/* current cost      */
+  int				defect_index;		/* defect index      */
   unsigned char			tag;			/* tag field         */
   bool				attached;		/* true if attached  */
-  void				*back;			/* back pointer      */
-  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  bool				batched;		/* change deferred   */
+  bool				dirty;			/* awaiting flush    */
   int				parent_index;		/* index in parent   */
-  int				defect_index;		/* defect index      */
-  int				trace_num;		/* trace visit num   */
+  int				index_in_soln;		/* not used here     */
+  KHE_SOLN			soln;			/* encl. solution    */
+  void				*back;			/* back pointer      */
   KHE_COST			trace_cost;		/* at start of trace */
-  KHE_COST			cost;			/* current cost      */
+  int				trace_num;		/* trace visit num   */
   ARRAY_KHE_MONITOR		child_monitors;		/* child monitors    */
   ARRAY_KHE_MONITOR		defects;		/* defects           */
   ARRAY_KHE_MONITOR		defects_copy;		/* copy of defects   */
@@ -84,6 +86,9 @@ struct khe_soln_rec {
   ARRAY_KHE_TRACE		free_traces;		/* free list         */
   ARRAY_KHE_TRANSACTION		free_transactions;	/* free list of t's  */
   ARRAY_KHE_TRANSACTION		curr_transactions;	/* current trans's   */
+  int				batch_depth;		/* batch nesting     */
+  ARRAY_KHE_MONITOR		batch_monitors;		/* deferred monitors */
+  ARRAY_INT64			batch_costs;		/* reported costs    */
   KHE_TIME_GROUP		curr_time_group;	/* temp variable     */
   KHE_RESOURCE_GROUP		curr_resource_group;	/* temp variable     */
   KHE_EVENT_GROUP		curr_event_group;	/* temp variable     */
@@ -109,6 +114,8 @@ struct khe_soln_rec {
   ARRAY_SHORT			matching_zero_domain;	/* domain { 0 }      */
   int				diversifier;		/* diversifier       */
   int				visit_num;		/* visit number      */
+  uint64_t			assign_hash;		/* Zobrist asst hash */
+  bool				deleting;		/* in KheSolnDelete  */
   KHE_SOLN			copy;			/* used when copying */
 };
 
@@ -919,6 +926,11 @@ KHE_SOLN KheSolnMake(KHE_INSTANCE ins, KHE_SOLN_GROUP soln_group)
   res->sub_tag = -1;
   res->sub_tag_label = "Soln";
 
+  /* batching (must precede anything that adds child monitors) */
+  res->batch_depth = 0;
+  MArrayInit(res->batch_monitors);
+  MArrayInit(res->batch_costs);
+
   /* instance and solution group */
   res->instance = ins;
   if( soln_group != NULL )
@@ -992,9 +1004,11 @@ KHE_SOLN KheSolnMake(KHE_INSTANCE ins, KHE_SOLN_GROUP soln_group)
   KheSolnAddInitialCycleMeet(res);
   KheSolnAddCycleTasks(res);
 
-  /* diversifier, visit_num and copy */
+  /* diversifier, visit_num, assign_hash, deleting and copy */
   res->diversifier = 0;
   res->visit_num = 0;
+  res->assign_hash = 0;
+  res->deleting = false;
   res->copy = NULL;
 
   /* make and attach constraint monitors */
@@ -1087,6 +1101,9 @@ void KheSolnDelete(KHE_SOLN soln)
   if( soln->soln_group != NULL )
     KheSolnGroupDeleteSoln(soln->soln_group, soln);
 
+  /* the assignment hash is not kept up to date from here on */
+  soln->deleting = true;
+
   /* delete taskings and tasks */
   while( MArraySize(soln->taskings) > 0 )
   {
@@ -1213,6 +1230,10 @@ void KheSolnDelete(KHE_SOLN soln)
   /* delete evenness handler */
   KheEvennessHandlerDelete(soln->evenness_handler);
 
+  /* batching (nothing is pending, but deletions above may flush) */
+  MArrayFree(soln->batch_monitors);
+  MArrayFree(soln->batch_costs);
+
   MFree(soln);
 
   if( DEBUG9 )
@@ -1294,6 +1315,9 @@ KHE_SOLN KheSolnCopyPhase1(KHE_SOLN soln)
     MArrayInit(copy->free_traces);
     MArrayInit(copy->free_transactions);
     MArrayInit(copy->curr_transactions);
+    copy->batch_depth = 0;
+    MArrayInit(copy->batch_monitors);
+    MArrayInit(copy->batch_costs);
     copy->curr_time_group = NULL;
     copy->curr_resource_group = NULL;
     copy->curr_event_group = NULL;
@@ -1341,6 +1365,8 @@ KHE_SOLN KheSolnCopyPhase1(KHE_SOLN soln)
     MArrayAddLast(copy->matching_zero_domain, 0);
     copy->diversifier = soln->diversifier;
     copy->visit_num = soln->visit_num;
+    copy->assign_hash = soln->assign_hash;
+    copy->deleting = false;
     copy->copy = NULL;
     if( DEBUG13 )
       fprintf(stderr, "] KheSolnCopyPhase1 returning\n");
@@ -1414,6 +1440,7 @@ KHE_SOLN KheSolnCopy(KHE_SOLN soln)
     "KheSolnCopy called after unmatched KheTransactionBegin");
 
   KheSolnMatchingUpdate(soln);
+  KheSolnBatchFlush(soln);
   copy = KheSolnCopyPhase1(soln);
   KheSolnCopyPhase2(soln);
   return copy;
@@ -1606,6 +1633,7 @@ double KheCostShow(KHE_COST combined_cost)
 KHE_COST KheSolnCost(KHE_SOLN soln)
 {
   KheMatchingUnmatchedDemandNodeCount(soln->matching);
+  KheSolnBatchFlush(soln);
   return soln->cost;
 }
 
@@ -2068,6 +2096,7 @@ void KheSolnAddMonitor(KHE_SOLN soln, KHE_MONITOR m, int *index_in_soln)
 void KheSolnDeleteMonitor(KHE_SOLN soln, KHE_MONITOR m)
 {
   KHE_MONITOR tmp;
+  KheSolnBatchFlush(soln);
   tmp = MArrayRemoveAndPlug(soln->monitors, KheMonitorIndexInSoln(m));
   KheMonitorSetIndexInSoln(tmp, KheMonitorIndexInSoln(m));
 }
@@ -2126,7 +2155,10 @@ void KheSolnAddMeet(KHE_SOLN soln, KHE_MEET meet, int *index_in_soln)
 /*                                                                           */
 /*  void KheSolnDeleteMeet(KHE_SOLN soln, KHE_MEET meet)                     */
 /*                                                                           */
-/*  Delete meet from soln.                                                   */
+/*  Delete meet from soln.  Meet is unassigned by now and nothing is         */
+/*  assigned to it, so only the last meet, which takes its index, changes    */
+/*  the assignment hash.  KheMeetMerge is the exception: it deletes meet2    */
+/*  while still assigned, and rehashes from scratch afterwards.              */
 /*                                                                           */
 /*****************************************************************************/
 
@@ -2137,7 +2169,34 @@ void KheSolnDeleteMeet(KHE_SOLN soln, KHE_MEET meet)
 
   /* remove from meets */
   tmp = MArrayRemoveAndPlug(soln->meets, KheMeetIndex(meet));
-  KheMeetSetIndex(tmp, KheMeetIndex(meet));
+  if( tmp != meet && !soln->deleting )
+  {
+    KheSolnAssignHashToggleMeet(soln, tmp);
+    KheMeetSetIndex(tmp, KheMeetIndex(meet));
+    KheSolnAssignHashToggleMeet(soln, tmp);
+  }
+  else
+    KheMeetSetIndex(tmp, KheMeetIndex(meet));
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnSwapMeets(KHE_SOLN soln, int index1, int index2)             */
+/*                                                                           */
+/*  Swap the meets at index1 and index2 of soln.  Undoing a meet merge uses  */
+/*  this to put the restored meet back at its old index.                     */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnSwapMeets(KHE_SOLN soln, int index1, int index2)
+{
+  KHE_MEET tmp;  KHE_TRANSACTION t;  int i;
+  MArraySwap(soln->meets, index1, index2, tmp);
+  KheMeetSetIndex(MArrayGet(soln->meets, index1), index1);
+  KheMeetSetIndex(MArrayGet(soln->meets, index2), index2);
+  MArrayForEach(soln->curr_transactions, &t, &i)
+    KheTransactionLogMeetSwap(t, index1, index2);
 }
 
 
@@ -2565,6 +2624,25 @@ KHE_NODE KheSolnNode(KHE_SOLN soln, int i)
 /*                                                                           */
 /*****************************************************************************/
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnSwapTasks(KHE_SOLN soln, int index1, int index2)             */
+/*                                                                           */
+/*  Swap the tasks at index1 and index2 of soln, like KheSolnSwapMeets.      */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnSwapTasks(KHE_SOLN soln, int index1, int index2)
+{
+  KHE_TASK tmp;  KHE_TRANSACTION t;  int i;
+  MArraySwap(soln->tasks, index1, index2, tmp);
+  KheTaskSetIndexInSoln(MArrayGet(soln->tasks, index1), index1);
+  KheTaskSetIndexInSoln(MArrayGet(soln->tasks, index2), index2);
+  MArrayForEach(soln->curr_transactions, &t, &i)
+    KheTransactionLogTaskSwap(t, index1, index2);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  KHE_TASK KheSolnGetTaskFromFreeList(KHE_SOLN soln)                       */
@@ -2615,7 +2693,8 @@ void KheSolnAddTask(KHE_SOLN soln, KHE_TASK task, int *index_in_soln)
 /*                                                                           */
 /*  void KheSolnDeleteTask(KHE_SOLN soln, KHE_TASK task)                     */
 /*                                                                           */
-/*  Delete task from soln.                                                   */
+/*  Delete task from soln.  As for meets, only the task that takes its       */
+/*  index changes the assignment hash, except when merging.                  */
 /*                                                                           */
 /*****************************************************************************/
 
@@ -2623,7 +2702,14 @@ void KheSolnDeleteTask(KHE_SOLN soln, KHE_TASK task)
 {
   KHE_TASK tmp;
   tmp = MArrayRemoveAndPlug(soln->tasks, KheTaskIndexInSoln(task));
-  KheTaskSetIndexInSoln(tmp, KheTaskIndexInSoln(task));
+  if( tmp != task && !soln->deleting )
+  {
+    KheSolnAssignHashToggleTask(soln, tmp);
+    KheTaskSetIndexInSoln(tmp, KheTaskIndexInSoln(task));
+    KheSolnAssignHashToggleTask(soln, tmp);
+  }
+  else
+    KheTaskSetIndexInSoln(tmp, KheTaskIndexInSoln(task));
 }
 
 
@@ -3212,13 +3298,15 @@ void KheSolnAddTransactionToFreeList(KHE_SOLN soln, KHE_TRANSACTION t)
 /*                                                                           */
 /*  void KheSolnBeginTransaction(KHE_SOLN soln, KHE_TRANSACTION t)           */
 /*                                                                           */
-/*  Add t to soln's list of current transactions.                            */
+/*  Add t to soln's list of current transactions.  Soln batches cost         */
+/*  changes while any transaction is current.                                */
 /*                                                                           */
 /*****************************************************************************/
 
 void KheSolnBeginTransaction(KHE_SOLN soln, KHE_TRANSACTION t)
 {
   MArrayAddLast(soln->curr_transactions, t);
+  KheSolnBeginBatch(soln);
 }
 
 
@@ -3236,9 +3324,269 @@ void KheSolnEndTransaction(KHE_SOLN soln, KHE_TRANSACTION t)
   if( !MArrayContains(soln->curr_transactions, t, &pos) )
     MAssert(false, "KheSolnEndTransaction internal error");
   MArrayRemove(soln->curr_transactions, pos);
+  KheSolnEndBatch(soln);
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheSolnTransactionOpen(KHE_SOLN soln)                               */
+/*                                                                           */
+/*  Return true if some transaction of soln has begun and not yet ended.     */
+/*  KheSolnCopy may not be called while this is so.                          */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheSolnTransactionOpen(KHE_SOLN soln)
+{
+  return MArraySize(soln->curr_transactions) > 0;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Submodule "batching"                                                     */
+/*                                                                           */
+/*  While soln is batching, cost changes in monitors are not passed up to    */
+/*  their parents one by one.  Each monitor whose cost changes is recorded   */
+/*  once, along with the cost its parent last saw, and the parents (and      */
+/*  their defect lists) are brought up to date when the batch is flushed.    */
+/*  A monitor that changes several times within the batch, or changes and    */
+/*  changes back, thus costs its ancestors at most one update.               */
+/*                                                                           */
+/*  Anything that reads costs or defects through a group monitor flushes     */
+/*  the batch first, so batching is invisible to the user.                   */
+/*                                                                           */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnBeginBatch(KHE_SOLN soln)                                    */
+/*                                                                           */
+/*  Begin a batch of cost changes.  Batches may nest.                        */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnBeginBatch(KHE_SOLN soln)
+{
+  soln->batch_depth++;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnEndBatch(KHE_SOLN soln)                                      */
+/*                                                                           */
+/*  End a batch of cost changes.  If it is the outermost batch, flush it.    */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnEndBatch(KHE_SOLN soln)
+{
+  MAssert(soln->batch_depth > 0,
+    "KheSolnEndBatch called without matching KheSolnBeginBatch");
+  if( soln->batch_depth == 1 )
+    KheSolnBatchFlush(soln);
+  soln->batch_depth--;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheSolnBatching(KHE_SOLN soln)                                      */
+/*                                                                           */
+/*  Return true if soln is currently batching cost changes.                  */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheSolnBatching(KHE_SOLN soln)
+{
+  return soln->batch_depth > 0;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnBatchAddMonitor(KHE_SOLN soln, KHE_MONITOR m,                */
+/*    KHE_COST reported_cost)                                                */
+/*                                                                           */
+/*  Add m to soln's batch; reported_cost is its cost as its parent has it.   */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnBatchAddMonitor(KHE_SOLN soln, KHE_MONITOR m,
+  KHE_COST reported_cost)
+{
+  MArrayAddLast(soln->batch_monitors, m);
+  MArrayAddLast(soln->batch_costs, reported_cost);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnBatchFlush(KHE_SOLN soln)                                    */
+/*                                                                           */
+/*  Pass the cost changes recorded in soln's batch to the parent monitors.   */
+/*  While still batching, a parent whose cost changes joins the batch        */
+/*  itself, so the loop continues until every level is up to date.           */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnBatchFlush(KHE_SOLN soln)
+{
+  KHE_MONITOR m;  KHE_COST reported_cost;
+  while( MArraySize(soln->batch_monitors) > 0 )
+  {
+    m = MArrayRemoveLast(soln->batch_monitors);
+    reported_cost = MArrayRemoveLast(soln->batch_costs);
+    KheMonitorFlushCostChange(m, reported_cost);
+  }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Submodule "assignment hashing"                                           */
+/*                                                                           */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                                                           */
+/*  uint64_t KheHashMix(uint64_t x)                                          */
+/*                                                                           */
+/*  Scramble x (the splitmix64 finaliser).  This stands in for a table of    */
+/*  random Zobrist keys, which would be far too large to store here.         */
+/*                                                                           */
+/*****************************************************************************/
+
+static uint64_t KheHashMix(uint64_t x)
+{
+  x += 0x9E3779B97F4A7C15ULL;
+  x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+  return x ^ (x >> 31);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  uint64_t KheMeetAsstHashKey(KHE_MEET meet, KHE_MEET target_meet,         */
+/*    int target_offset)                                                     */
+/*                                                                           */
+/*  Return the key of the assignment of meet to target_meet at offset.       */
+/*  Keys depend on indexes only, so copies of a soln hash identically.       */
+/*                                                                           */
+/*****************************************************************************/
+
+static uint64_t KheMeetAsstHashKey(KHE_MEET meet, KHE_MEET target_meet,
+  int target_offset)
+{
+  uint64_t x;
+  x = KheHashMix((uint64_t) KheMeetIndex(meet) << 1);
+  x = KheHashMix(x ^ (uint64_t) KheMeetIndex(target_meet));
+  return KheHashMix(x ^ (uint64_t) target_offset);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  uint64_t KheTaskAsstHashKey(KHE_TASK task, KHE_TASK target_task)        */
+/*                                                                           */
+/*  Return the key of the assignment of task to target_task.                 */
+/*                                                                           */
+/*****************************************************************************/
+
+static uint64_t KheTaskAsstHashKey(KHE_TASK task, KHE_TASK target_task)
+{
+  uint64_t x;
+  x = KheHashMix(((uint64_t) KheTaskIndexInSoln(task) << 1) | 1);
+  return KheHashMix(x ^ (uint64_t) KheTaskIndexInSoln(target_task));
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnAssignHashToggleMeet(KHE_SOLN soln, KHE_MEET meet)           */
+/*                                                                           */
+/*  Xor into soln's assignment hash the keys that depend on meet's index:    */
+/*  that of meet's own assignment and those of the meets assigned to it.     */
+/*  Calling this before and after a change of index updates the hash.       */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnAssignHashToggleMeet(KHE_SOLN soln, KHE_MEET meet)
+{
+  KHE_MEET child;  int i;
+  if( KheMeetAsst(meet) != NULL )
+    soln->assign_hash ^=
+      KheMeetAsstHashKey(meet, KheMeetAsst(meet), KheMeetAsstOffset(meet));
+  for( i = 0;  i < KheMeetAssignedToCount(meet);  i++ )
+  {
+    child = KheMeetAssignedTo(meet, i);
+    soln->assign_hash ^=
+      KheMeetAsstHashKey(child, meet, KheMeetAsstOffset(child));
+  }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnAssignHashToggleTask(KHE_SOLN soln, KHE_TASK task)           */
+/*                                                                           */
+/*  Like KheSolnAssignHashToggleMeet, for the keys that depend on task's     */
+/*  index.                                                                   */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnAssignHashToggleTask(KHE_SOLN soln, KHE_TASK task)
+{
+  int i;
+  if( KheTaskAsst(task) != NULL )
+    soln->assign_hash ^= KheTaskAsstHashKey(task, KheTaskAsst(task));
+  for( i = 0;  i < KheTaskAssignedToCount(task);  i++ )
+    soln->assign_hash ^= KheTaskAsstHashKey(KheTaskAssignedTo(task, i), task);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnAssignHashReset(KHE_SOLN soln)                               */
+/*                                                                           */
+/*  Recalculate soln's assignment hash from scratch.  This is needed when    */
+/*  meets are split or merged; deletions update the hash incrementally.      */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnAssignHashReset(KHE_SOLN soln)
+{
+  KHE_MEET meet;  KHE_TASK task;  int i;
+  soln->assign_hash = 0;
+  MArrayForEach(soln->meets, &meet, &i)
+    if( KheMeetAsst(meet) != NULL )
+      soln->assign_hash ^=
+	KheMeetAsstHashKey(meet, KheMeetAsst(meet), KheMeetAsstOffset(meet));
+  MArrayForEach(soln->tasks, &task, &i)
+    if( KheTaskAsst(task) != NULL )
+      soln->assign_hash ^= KheTaskAsstHashKey(task, KheTaskAsst(task));
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  uint64_t KheSolnAssignHash(KHE_SOLN soln)                                */
+/*                                                                           */
+/*  Return a 64-bit hash of the meet and task assignments of soln.  It is    */
+/*  maintained incrementally by KheMeetAssign, KheTaskAssign, and their      */
+/*  inverses, so KheTransactionUndo restores it along with the assignments.  */
+/*                                                                           */
+/*****************************************************************************/
+
+uint64_t KheSolnAssignHash(KHE_SOLN soln)
+{
+  return soln->assign_hash;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  Submodule "transaction operation loading"                                */
@@ -3290,22 +3638,42 @@ void KheSolnOpMeetSplit(KHE_SOLN soln, KHE_MEET meet1, KHE_MEET meet2)
   KHE_TRANSACTION t;  int i;
   MArrayForEach(soln->curr_transactions, &t, &i)
     KheTransactionOpMeetSplit(t, meet1, meet2);
+  KheSolnAssignHashReset(soln);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnOpMeetMerge(KHE_SOLN soln, KHE_MEET meet1, KHE_MEET meet2)   */
+/*                                                                           */
+/*  Inform soln that a call to KheMeetMerge is about to merge meet2 into     */
+/*  meet1.  Each pair of tasks merged follows, by KheSolnOpMeetMergeTask.    */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnOpMeetMerge(KHE_SOLN soln, KHE_MEET meet1, KHE_MEET meet2)
+{
+  KHE_TRANSACTION t;  int i;
+  MArrayForEach(soln->curr_transactions, &t, &i)
+    KheTransactionOpMeetMerge(t, meet1, meet2);
 }
 
 
 /*****************************************************************************/
 /*                                                                           */
-/*  void KheSolnOpMeetMerge(KHE_SOLN soln)                                   */
+/*  void KheSolnOpMeetMergeTask(KHE_SOLN soln, KHE_TASK task1,               */
+/*    KHE_TASK task2)                                                        */
 /*                                                                           */
-/*  Inform soln that a call to KheMeetMerge has occurred.                    */
+/*  Inform soln that the KheMeetMerge in progress is about to merge task2    */
+/*  into task1.                                                              */
 /*                                                                           */
 /*****************************************************************************/
 
-void KheSolnOpMeetMerge(KHE_SOLN soln)
+void KheSolnOpMeetMergeTask(KHE_SOLN soln, KHE_TASK task1, KHE_TASK task2)
 {
   KHE_TRANSACTION t;  int i;
   MArrayForEach(soln->curr_transactions, &t, &i)
-    KheTransactionOpMeetMerge(t);
+    KheTransactionOpMeetMergeTask(t, task1, task2);
 }
 
 
@@ -3324,6 +3692,8 @@ void KheSolnOpMeetAssign(KHE_SOLN soln, KHE_MEET meet,
   KHE_TRANSACTION t;  int i;
   MArrayForEach(soln->curr_transactions, &t, &i)
     KheTransactionOpMeetAssign(t, meet, target_meet, target_offset);
+  if( !soln->deleting )
+    soln->assign_hash ^= KheMeetAsstHashKey(meet, target_meet, target_offset);
 }
 
 
@@ -3342,6 +3712,8 @@ void KheSolnOpMeetUnAssign(KHE_SOLN soln, KHE_MEET meet,
   KHE_TRANSACTION t;  int i;
   MArrayForEach(soln->curr_transactions, &t, &i)
     KheTransactionOpMeetUnAssign(t, meet, target_meet, target_offset);
+  if( !soln->deleting )
+    soln->assign_hash ^= KheMeetAsstHashKey(meet, target_meet, target_offset);
 }
 
 
@@ -3409,6 +3781,8 @@ void KheSolnOpTaskAssign(KHE_SOLN soln, KHE_TASK task, KHE_TASK target_task)
   KHE_TRANSACTION t;  int i;
   MArrayForEach(soln->curr_transactions, &t, &i)
     KheTransactionOpTaskAssign(t, task, target_task);
+  if( !soln->deleting )
+    soln->assign_hash ^= KheTaskAsstHashKey(task, target_task);
 }
 
 
@@ -3426,6 +3800,8 @@ void KheSolnOpTaskUnAssign(KHE_SOLN soln, KHE_TASK task, KHE_TASK target_task)
   KHE_TRANSACTION t;  int i;
   MArrayForEach(soln->curr_transactions, &t, &i)
     KheTransactionOpTaskUnAssign(t, task, target_task);
+  if( !soln->deleting )
+    soln->assign_hash ^= KheTaskAsstHashKey(task, target_task);
 }
 
 
@@ -87,6 +87,30 @@ bool KheSolnGroupMake(KHE_ARCHIVE archive, char *id,
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnGroupDelete(KHE_SOLN_GROUP soln_group)                       */
+/*                                                                           */
+/*  Delete soln_group and its metadata, removing it from its archive.  Its   */
+/*  solutions are not deleted, but they no longer lie in any solution        */
+/*  group.  The id and metadata strings are not freed, since they were       */
+/*  passed in by the caller and not copied.                                  */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnGroupDelete(KHE_SOLN_GROUP soln_group)
+{
+  while( MArraySize(soln_group->solutions) > 0 )
+    KheSolnSetSolnGroup(MArrayRemoveLast(soln_group->solutions), NULL);
+  MArrayFree(soln_group->solutions);
+  if( soln_group->archive != NULL )
+    KheArchiveDeleteSolnGroup(soln_group->archive, soln_group);
+  if( soln_group->meta_data != NULL )
+    KheSolnGroupMetaDataDelete(soln_group->meta_data);
+  MFree(soln_group);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheSolnGroupSetBack(KHE_SOLN_GROUP soln_group, void *back)          */
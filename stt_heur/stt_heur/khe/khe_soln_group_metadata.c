@@ -73,6 +73,20 @@ KHE_SOLN_GROUP_METADATA KheSolnGroupMetaDataMake(char *contributor,
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSolnGroupMetaDataDelete(KHE_SOLN_GROUP_METADATA md)              */
+/*                                                                           */
+/*  Delete md, but not its strings, which were not copied when it was made.  */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheSolnGroupMetaDataDelete(KHE_SOLN_GROUP_METADATA md)
+{
+  MFree(md);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  char *KheSolnGroupMetaDataContributor(KHE_SOLN_GROUP_METADATA md)        */
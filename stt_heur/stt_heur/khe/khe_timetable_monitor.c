@@ -61,24 +61,29 @@ struct khe_time_cell_rec {
 struct khe_timetable_monitor_rec {
 
   /* inherited from KHE_MONITOR */
-  KHE_SOLN			soln;			/* encl. solution    */
-  int				index_in_soln;		/* index in soln     */
+  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  KHE_COST			cost;			/* current cost      */
+  int				defect_index;		/* defect index      */
   unsigned char			tag;			/* tag field         */
   bool				attached;		/* true if attached  */
-  void				*back;			/* back pointer      */
-  KHE_GROUP_MONITOR		parent_monitor;		/* parent monitor    */
+  bool				batched;		/* change deferred   */
+  bool				dirty;			/* awaiting flush    */
   int				parent_index;		/* index in parent   */
-  int				defect_index;		/* defect index      */
-  int				trace_num;		/* trace visit num   */
+  int				index_in_soln;		/* index in soln     */
+  KHE_SOLN			soln;			/* encl. solution    */
+  void				*back;			/* back pointer      */
   KHE_COST			trace_cost;		/* at start of trace */
-  KHE_COST			cost;			/* current cost      */
+  int				trace_num;		/* trace visit num   */
 
   /* specific to KHE_TIMETABLE_MONITOR */
   KHE_RESOURCE_IN_SOLN 		resource_in_soln;	/* resource or...    */
   KHE_EVENT_IN_SOLN		event_in_soln;		/* event             */
   ARRAY_KHE_TIME_CELL		time_cells;		/* time cells        */
+  LSET				busy_times;		/* cells with meets  */
   ARRAY_KHE_AVOID_CLASHES_MONITOR avoid_clashes_monitors; /* some monitors   */
   ARRAY_KHE_MONITOR		other_monitors;		/* other monitors    */
+  ARRAY_KHE_MONITOR		dirty_tg_monitors;	/* awaiting flush    */
+  ARRAY_KHE_MONITOR		dirty_monitors;		/* awaiting flush    */
   KHE_TIMETABLE_MONITOR		copy;			/* used when copying */
 };
 
@@ -175,6 +180,40 @@ static void KheTimeCellDelete(KHE_TIME_CELL tc)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTimeCellDeleteMeet(KHE_TIME_CELL tc, KHE_MEET meet)              */
+/*                                                                           */
+/*  Delete one occurrence of meet from tc.  The order of tc's meets is not   */
+/*  significant, so the hole is plugged by the last meet instead of being    */
+/*  closed up.  The search runs backwards because the meet deleted is        */
+/*  usually the one added most recently (when a move is undone).             */
+/*                                                                           */
+/*  Implementation note.  There is no index of each meet's position in each  */
+/*  cell, so the search is linear in the clash depth.  An index would have   */
+/*  to allow for a meet occurring twice in one cell (two of its tasks        */
+/*  assigned the same resource), be handed over when a meet is split or      */
+/*  merged, and be copied by KheSolnCopy.  It would gain little: on          */
+/*  BrazilInstance4 the search examines 1.1 to 1.3 meets on average during   */
+/*  a run (never more than 3), and 3.9 with mean clash depth 6.6 in the      */
+/*  clash-heavy case of bench/timetable_bench.cpp, against roughly 550 ns    */
+/*  per move there.  The occupancy of tc is MArraySize(tc->meets).           */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTimeCellDeleteMeet(KHE_TIME_CELL tc, KHE_MEET meet)
+{
+  int pos;
+  for( pos = MArraySize(tc->meets) - 1;  pos >= 0;  pos-- )
+    if( MArrayGet(tc->meets, pos) == meet )
+    {
+      MArrayRemoveAndPlug(tc->meets, pos);
+      return;
+    }
+  MAssert(false, "KheTimeCellDeleteMeet internal error");
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheTimeCellDebug(KHE_TIME_CELL tc, int verbosity, int indent,       */
@@ -251,8 +290,17 @@ KHE_TIMETABLE_MONITOR KheTimetableMonitorMake(KHE_SOLN soln,
     tc = KheTimeCellMake(KheInstanceTime(ins, i));
     MArrayAddLast(res->time_cells, tc);
   }
+  res->busy_times = LSetNew();
+  if( KheInstanceTimeCount(ins) > 0 )
+  {
+    /* enlarge now, so that no later insertion needs to reallocate */
+    LSetInsert(&res->busy_times, KheInstanceTimeCount(ins) - 1);
+    LSetDelete(res->busy_times, KheInstanceTimeCount(ins) - 1);
+  }
   MArrayInit(res->avoid_clashes_monitors);
   MArrayInit(res->other_monitors);
+  MArrayInit(res->dirty_tg_monitors);
+  MArrayInit(res->dirty_monitors);
   res->copy = NULL;
   /* KheGroupMonitorAddMonitor((KHE_GROUP_MONITOR) soln, (KHE_MONITOR) res); */
   return res;
@@ -284,6 +332,7 @@ KHE_TIMETABLE_MONITOR KheTimetableMonitorCopyPhase1(KHE_TIMETABLE_MONITOR tm)
     MArrayInit(copy->time_cells);
     MArrayForEach(tm->time_cells, &tc, &i)
       MArrayAddLast(copy->time_cells, KheTimeCellCopyPhase1(tc));
+    copy->busy_times = LSetCopy(tm->busy_times);
     MArrayInit(copy->avoid_clashes_monitors);
     MArrayForEach(tm->avoid_clashes_monitors, &acm, &i)
       MArrayAddLast(copy->avoid_clashes_monitors,
@@ -291,6 +340,8 @@ KHE_TIMETABLE_MONITOR KheTimetableMonitorCopyPhase1(KHE_TIMETABLE_MONITOR tm)
     MArrayInit(copy->other_monitors);
     MArrayForEach(tm->other_monitors, &m, &i)
       MArrayAddLast(copy->other_monitors, KheMonitorCopyPhase1(m));
+    MArrayInit(copy->dirty_tg_monitors);
+    MArrayInit(copy->dirty_monitors);
     copy->copy = NULL;
   }
   return tm->copy;
@@ -340,8 +391,11 @@ void KheTimetableMonitorDelete(KHE_TIMETABLE_MONITOR tm)
   MArrayForEach(tm->time_cells, &tc, &i)
     KheTimeCellDelete(tc);
   MArrayFree(tm->time_cells);
+  LSetFree(tm->busy_times);
   MArrayFree(tm->avoid_clashes_monitors);
   MArrayFree(tm->other_monitors);
+  MArrayFree(tm->dirty_tg_monitors);
+  MArrayFree(tm->dirty_monitors);
   MFree(tm);
 }
 
@@ -381,6 +435,113 @@ KHE_MEET KheTimetableMonitorTimeMeet(KHE_TIMETABLE_MONITOR tm,
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheTimetableMonitorIsOccupied(KHE_TIMETABLE_MONITOR tm,             */
+/*    int time_index)                                                        */
+/*                                                                           */
+/*  Return true if at least one meet is running at time_index.               */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheTimetableMonitorIsOccupied(KHE_TIMETABLE_MONITOR tm, int time_index)
+{
+  return LSetContains(tm->busy_times, time_index);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  Submodule "busy times"                                                   */
+/*                                                                           */
+/*  Alongside its time cells, each timetable keeps busy_times, the set of    */
+/*  indexes of the cells containing at least one meet.  It is updated only   */
+/*  when a cell becomes empty or non-empty, and it lets these queries test   */
+/*  whole words of times at once instead of visiting the cells.  Like the    */
+/*  cells themselves, it is only kept up to date while tm is attached.       */
+/*                                                                           */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheTimetableMonitorTimesAreFree(KHE_TIMETABLE_MONITOR tm,           */
+/*    KHE_TIME time, int durn)                                               */
+/*                                                                           */
+/*  Return true if no meet is running at time or at any of the durn - 1      */
+/*  times following it.  If those times run off the end of the cycle,        */
+/*  return false, since no meet of duration durn could run there.            */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheTimetableMonitorTimesAreFree(KHE_TIMETABLE_MONITOR tm,
+  KHE_TIME time, int durn)
+{
+  int index;
+  MAssert(durn > 0, "KheTimetableMonitorTimesAreFree: durn (%d) out of range",
+    durn);
+  index = KheTimeIndex(time);
+  if( index + durn > MArraySize(tm->time_cells) )
+    return false;
+  return LSetIntervalDisjoint(tm->busy_times, index, index + durn - 1);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  int KheTimetableMonitorClashCount(KHE_TIMETABLE_MONITOR tm1,             */
+/*    KHE_TIMETABLE_MONITOR tm2)                                             */
+/*                                                                           */
+/*  Return the number of times at which both tm1 and tm2 are occupied;       */
+/*  that is, the number of clashes there would be if the two timetables      */
+/*  were merged into one.                                                    */
+/*                                                                           */
+/*****************************************************************************/
+
+int KheTimetableMonitorClashCount(KHE_TIMETABLE_MONITOR tm1,
+  KHE_TIMETABLE_MONITOR tm2)
+{
+  return LSetIntersectionCount(tm1->busy_times, tm2->busy_times);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  int KheTimetableMonitorsFreeTimes(KHE_TIMETABLE_MONITOR *tms,            */
+/*    int count, int durn, int *time_indexes)                                */
+/*                                                                           */
+/*  Set time_indexes to the indexes of the times t such that none of the     */
+/*  count timetables tms[0 .. count-1] is occupied at t or at any of the     */
+/*  durn - 1 times following it, in increasing order, and return the number  */
+/*  of them.  Array time_indexes must have room for one entry per time of    */
+/*  the instance.                                                            */
+/*                                                                           */
+/*  Implementation note.  This is called once per move by some solvers, so   */
+/*  each timetable's busy times are tested in place rather than copied into  */
+/*  a union, which would allocate memory on every call.                      */
+/*                                                                           */
+/*****************************************************************************/
+
+int KheTimetableMonitorsFreeTimes(KHE_TIMETABLE_MONITOR *tms, int count,
+  int durn, int *time_indexes)
+{
+  int i, j, res, time_count;
+  MAssert(count > 0, "KheTimetableMonitorsFreeTimes: count is 0");
+  MAssert(durn > 0, "KheTimetableMonitorsFreeTimes: durn (%d) out of range",
+    durn);
+  time_count = MArraySize(tms[0]->time_cells);
+  res = 0;
+  for( i = 0;  i + durn <= time_count;  i++ )
+  {
+    for( j = 0;  j < count;  j++ )
+      if( !LSetIntervalDisjoint(tms[j]->busy_times, i, i + durn - 1) )
+	break;
+    if( j == count )
+      time_indexes[res++] = i;
+  }
+  return res;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  Submodule "monitors"                                                     */
@@ -1145,6 +1306,66 @@ void KheTimetableMonitorMergeMeet(KHE_TIMETABLE_MONITOR tm,
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  static void KheTimetableMonitorMarkDirty(KHE_TIMETABLE_MONITOR tm,       */
+/*    KHE_TIME_CELL tc)                                                      */
+/*                                                                           */
+/*  Record that the monitors of tc have been informed of a change and so     */
+/*  need flushing.  Each monitor appears at most once in the dirty lists,    */
+/*  as recorded by its dirty flag.  Time group monitors go on their own      */
+/*  list, so that they can be flushed first, as in tm's other monitors.      */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTimetableMonitorMarkDirty(KHE_TIMETABLE_MONITOR tm,
+  KHE_TIME_CELL tc)
+{
+  KHE_MONITOR m;  int i;
+  MArrayForEach(tc->monitors, &m, &i)
+    if( !KheMonitorDirty(m) )
+    {
+      KheMonitorSetDirty(m, true);
+      if( KheMonitorTag(m) == KHE_TIME_GROUP_MONITOR_TAG )
+	MArrayAddLast(tm->dirty_tg_monitors, m);
+      else
+	MArrayAddLast(tm->dirty_monitors, m);
+    }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  static void KheTimetableMonitorFlushDirty(KHE_TIMETABLE_MONITOR tm,      */
+/*    bool clashes_changed)                                                  */
+/*                                                                           */
+/*  Flush the monitors marked dirty, and the avoid clashes monitors if       */
+/*  clashes_changed, then empty the dirty lists ready for the next call.     */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTimetableMonitorFlushDirty(KHE_TIMETABLE_MONITOR tm,
+  bool clashes_changed)
+{
+  KHE_MONITOR m;  KHE_AVOID_CLASHES_MONITOR acm;  int i;
+  if( clashes_changed )
+    MArrayForEach(tm->avoid_clashes_monitors, &acm, &i)
+      KheAvoidClashesMonitorFlush(acm);
+  MArrayForEach(tm->dirty_tg_monitors, &m, &i)
+  {
+    KheMonitorSetDirty(m, false);
+    KheMonitorFlush(m);
+  }
+  MArrayForEach(tm->dirty_monitors, &m, &i)
+  {
+    KheMonitorSetDirty(m, false);
+    KheMonitorFlush(m);
+  }
+  MArrayClear(tm->dirty_tg_monitors);
+  MArrayClear(tm->dirty_monitors);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheTimetableMonitorAssignTime(KHE_TIMETABLE_MONITOR tm,             */
@@ -1155,7 +1376,7 @@ void KheTimetableMonitorMergeMeet(KHE_TIMETABLE_MONITOR tm,
 /*  Implementation note.  As it happens, at each time we either inform       */
 /*  the monitors attached to that time that the resource has become busy     */
 /*  then, or else we inform all avoid clashes monitors that the resoure      */
-/*  resource has a clash then.                                               */
+/*  resource has a clash then.  Only the monitors so informed are flushed.   */
 /*                                                                           */
 /*****************************************************************************/
 
@@ -1163,9 +1384,11 @@ void KheTimetableMonitorAssignTime(KHE_TIMETABLE_MONITOR tm,
   KHE_MEET meet, int assigned_time_index)
 {
   int i, j;  KHE_TIME_CELL tc;  KHE_MONITOR m;  KHE_AVOID_CLASHES_MONITOR acm;
+  bool clashes_changed;
   if( DO_DEBUG4 )
     fprintf(stderr, "KheTimetableMonitorAssignTime(tm, meet, %d)\n",
       assigned_time_index);
+  clashes_changed = false;
   for( i = 0;  i < KheMeetDuration(meet);  i++ )
   {
     MAssert(0 <= assigned_time_index + i,
@@ -1174,18 +1397,22 @@ void KheTimetableMonitorAssignTime(KHE_TIMETABLE_MONITOR tm,
       "KheTimetableMonitorAssignTime internal error 2");
     tc = MArrayGet(tm->time_cells, assigned_time_index + i);
     if( MArraySize(tc->meets) == 0 )
+    {
       MArrayForEach(tc->monitors, &m, &j)
 	KheMonitorAssignNonClash(m, assigned_time_index + i);
+      KheTimetableMonitorMarkDirty(tm, tc);
+      LSetInsert(&tm->busy_times, assigned_time_index + i);
+    }
     else
+    {
       MArrayForEach(tm->avoid_clashes_monitors, &acm, &j)
 	KheAvoidClashesMonitorChangeClashCount(acm,
 	  MArraySize(tc->meets) - 1, MArraySize(tc->meets));
+      clashes_changed = true;
+    }
     MArrayAddLast(tc->meets, meet);
   }
-  MArrayForEach(tm->avoid_clashes_monitors, &acm, &i)
-    KheAvoidClashesMonitorFlush(acm);
-  MArrayForEach(tm->other_monitors, &m, &i)
-    KheMonitorFlush(m);
+  KheTimetableMonitorFlushDirty(tm, clashes_changed);
 }
 
 
@@ -1201,31 +1428,34 @@ void KheTimetableMonitorAssignTime(KHE_TIMETABLE_MONITOR tm,
 void KheTimetableMonitorUnAssignTime(KHE_TIMETABLE_MONITOR tm,
   KHE_MEET meet, int assigned_time_index)
 {
-  int i, j, pos;  KHE_TIME_CELL tc;  KHE_MONITOR m;
-  KHE_AVOID_CLASHES_MONITOR acm;
+  int i, j;  KHE_TIME_CELL tc;  KHE_MONITOR m;
+  KHE_AVOID_CLASHES_MONITOR acm;  bool clashes_changed;
   if( DO_DEBUG4 )
     fprintf(stderr, "KheTimetableMonitorUnAssignTime(tm, meet, %d)\n",
       assigned_time_index);
+  clashes_changed = false;
   for( i = 0;  i < KheMeetDuration(meet);  i++ )
   {
     tc = MArrayGet(tm->time_cells, assigned_time_index + i);
-    if( !MArrayContains(tc->meets, meet, &pos) )
-      MAssert(false, "KheTimetableMonitorUnAssignTime internal error)");
-    MArrayRemove(tc->meets, pos);
+    KheTimeCellDeleteMeet(tc, meet);
     if( MArraySize(tc->meets) == 0 )
+    {
       MArrayForEach(tc->monitors, &m, &j)
 	KheMonitorUnAssignNonClash(m, assigned_time_index + i);
+      KheTimetableMonitorMarkDirty(tm, tc);
+      LSetDelete(tm->busy_times, assigned_time_index + i);
+    }
     else
+    {
       MArrayForEach(tm->avoid_clashes_monitors, &acm, &j)
 	KheAvoidClashesMonitorChangeClashCount(acm,
 	  MArraySize(tc->meets), MArraySize(tc->meets) - 1);
+      clashes_changed = true;
+    }
   }
-  MArrayForEach(tm->avoid_clashes_monitors, &acm, &i)
-    KheAvoidClashesMonitorFlush(acm);
-  MArrayForEach(tm->other_monitors, &m, &i)
-    KheMonitorFlush(m);
+  KheTimetableMonitorFlushDirty(tm, clashes_changed);
 }
-
+
 
 /*****************************************************************************/
 /*                                                                           */
@@ -67,6 +67,16 @@ typedef struct khe_transaction_op_rec {
       KHE_MEET		meet1;
       KHE_MEET		meet2;
     } meet_split;
+    struct {
+      KHE_MEET		meet1;
+      KHE_MEET		meet2;
+      int		meet2_index;
+      int		duration1;
+      KHE_TIME_GROUP	domain2;
+      int		task_count;
+      int		first_task;
+      int		first_int;
+    } meet_merge;
     struct {
       KHE_MEET		meet;
       KHE_MEET		target_meet;
@@ -114,10 +124,73 @@ typedef struct khe_transaction_op_rec {
 typedef MARRAY(KHE_TRANSACTION_OP) ARRAY_KHE_TRANSACTION_OP;
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  KHE_PLACEHOLDER - stands in for a meet or task freed by a meet merge.    */
+/*                                                                           */
+/*****************************************************************************/
+
+typedef struct khe_placeholder_rec {
+  int				unused;			/* never accessed    */
+} *KHE_PLACEHOLDER;
+
+typedef MARRAY(KHE_PLACEHOLDER) ARRAY_KHE_PLACEHOLDER;
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  KHE_LOG_CODE - the code that begins each entry of a transaction log.     */
+/*                                                                           */
+/*  Each entry is a code followed by the indexes in the soln of the objects  */
+/*  it touches (a meet assignment also has its offset, a split its first     */
+/*  duration):                                                               */
+/*                                                                           */
+/*    KHE_LOG_MEET_SPLIT       meet, duration1                               */
+/*    KHE_LOG_MEET_MERGE       meet1, meet2                                  */
+/*    KHE_LOG_MEET_ASSIGN      meet, target_meet, target_offset              */
+/*    KHE_LOG_MEET_UNASSIGN    meet                                          */
+/*    KHE_LOG_MEET_SWAP        index1, index2                                */
+/*    KHE_LOG_TASK_ASSIGN      task, target_task                             */
+/*    KHE_LOG_TASK_UNASSIGN    task                                          */
+/*    KHE_LOG_TASK_SWAP        index1, index2                                */
+/*                                                                           */
+/*****************************************************************************/
+
+typedef enum {
+  KHE_LOG_MEET_SPLIT,
+  KHE_LOG_MEET_MERGE,
+  KHE_LOG_MEET_ASSIGN,
+  KHE_LOG_MEET_UNASSIGN,
+  KHE_LOG_MEET_SWAP,
+  KHE_LOG_TASK_ASSIGN,
+  KHE_LOG_TASK_UNASSIGN,
+  KHE_LOG_TASK_SWAP
+} KHE_LOG_CODE;
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  KHE_TRANSACTION - a transaction                                          */
 /*                                                                           */
+/*  A meet merge frees meet2 and its tasks, so undoing it must recreate      */
+/*  them.  For each pair of tasks merged, merge_tasks holds task1, task2,    */
+/*  and the tasks that were assigned to task2, and merge_ints holds task2's  */
+/*  index in the soln when it was deleted and the number of those tasks.     */
+/*                                                                           */
+/*  The freed meet2 and tasks are not mentioned by address afterwards,       */
+/*  because their memory may be reused, by the soln or by undoing a later    */
+/*  merge, for objects that the operations also mention.  Each of them is    */
+/*  replaced throughout the operations by a placeholder owned by t, which    */
+/*  no meet or task can share an address with; undoing the merge replaces    */
+/*  the placeholder by the recreated object.  Like operations, placeholders  */
+/*  are kept for reuse when t is begun again.                                */
+/*                                                                           */
+/*  When logging is on, each operation is also appended to log, in the       */
+/*  index form described above, as it happens.  Indexes change as meets and  */
+/*  tasks are split, merged and deleted, so they cannot be recovered from    */
+/*  the operations later.  An operation with no index form (making or        */
+/*  deleting an object, changing a domain or a node) clears log_portable.    */
+/*                                                                           */
 /*****************************************************************************/
 
 struct khe_transaction_rec {
@@ -127,6 +200,13 @@ struct khe_transaction_rec {
   bool				may_redo;		/* redo allowed      */
   int				operations_count;	/* no of operations  */
   ARRAY_KHE_TRANSACTION_OP	operations;		/* the operations    */
+  ARRAY_KHE_TASK		merge_tasks;		/* merged tasks      */
+  ARRAY_INT			merge_ints;		/* merged task info  */
+  int				placeholders_count;	/* no in use         */
+  ARRAY_KHE_PLACEHOLDER		placeholders;		/* freed objects     */
+  bool				logging;		/* keeping a log     */
+  bool				log_portable;		/* log replayable    */
+  ARRAY_INT			log;			/* the log           */
 };
 
 
@@ -153,8 +233,13 @@ KHE_TRANSACTION KheTransactionMake(KHE_SOLN soln)
     MMake(res);
     res->soln = soln;
     MArrayInit(res->operations);
+    MArrayInit(res->merge_tasks);
+    MArrayInit(res->merge_ints);
+    MArrayInit(res->placeholders);
+    MArrayInit(res->log);
   }
   res->loading = false;
+  res->logging = false;
   return res;
 }
 
@@ -204,6 +289,11 @@ void KheTransactionBegin(KHE_TRANSACTION t)
   t->may_undo = true;
   t->may_redo = true;
   t->operations_count = 0;
+  MArrayClear(t->merge_tasks);
+  MArrayClear(t->merge_ints);
+  t->placeholders_count = 0;
+  MArrayClear(t->log);
+  t->log_portable = true;
   KheSolnBeginTransaction(t->soln, t);
 }
 
@@ -237,6 +327,12 @@ void KheTransactionFree(KHE_TRANSACTION t)
 {
   while( MArraySize(t->operations) > 0 )
     MFree(MArrayRemoveLast(t->operations));
+  MArrayFree(t->merge_tasks);
+  MArrayFree(t->merge_ints);
+  while( MArraySize(t->placeholders) > 0 )
+    MFree(MArrayRemoveLast(t->placeholders));
+  MArrayFree(t->placeholders);
+  MArrayFree(t->log);
   MFree(t);
 }
 
@@ -270,6 +366,198 @@ static KHE_TRANSACTION_OP GetOp(KHE_TRANSACTION t)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  KHE_PLACEHOLDER GetPlaceholder(KHE_TRANSACTION t)                        */
+/*                                                                           */
+/*  Get a new placeholder for t, either from t's free list or fresh.         */
+/*                                                                           */
+/*****************************************************************************/
+
+static KHE_PLACEHOLDER GetPlaceholder(KHE_TRANSACTION t)
+{
+  KHE_PLACEHOLDER res;
+  if( t->placeholders_count == MArraySize(t->placeholders) )
+  {
+    MMake(res);
+    MArrayAddLast(t->placeholders, res);
+  }
+  else
+    res = MArrayGet(t->placeholders, t->placeholders_count);
+  t->placeholders_count++;
+  return res;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheTransactionIsPlaceholder(KHE_TRANSACTION t, void *obj)           */
+/*                                                                           */
+/*  Return true if obj, a meet or task mentioned by t, is a placeholder.     */
+/*                                                                           */
+/*****************************************************************************/
+
+static bool KheTransactionIsPlaceholder(KHE_TRANSACTION t, void *obj)
+{
+  int i;
+  for( i = 0;  i < t->placeholders_count;  i++ )
+    if( (void *) MArrayGet(t->placeholders, i) == obj )
+      return true;
+  return false;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionReplaceMeet(KHE_TRANSACTION t, KHE_MEET old_meet,     */
+/*    KHE_MEET new_meet)                                                     */
+/*                                                                           */
+/*  Replace old_meet by new_meet in every operation recorded so far in t.    */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionReplaceMeet(KHE_TRANSACTION t, KHE_MEET old_meet,
+  KHE_MEET new_meet)
+{
+  KHE_TRANSACTION_OP op;  int i;
+  for( i = 0;  i < t->operations_count;  i++ )
+  {
+    op = MArrayGet(t->operations, i);
+    switch( op->type )
+    {
+      case KHE_TRANSACTION_OP_MEET_MAKE:
+
+	if( op->u.meet_make.res == old_meet )
+	  op->u.meet_make.res = new_meet;
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_SPLIT:
+
+	if( op->u.meet_split.meet1 == old_meet )
+	  op->u.meet_split.meet1 = new_meet;
+	if( op->u.meet_split.meet2 == old_meet )
+	  op->u.meet_split.meet2 = new_meet;
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_MERGE:
+
+	if( op->u.meet_merge.meet1 == old_meet )
+	  op->u.meet_merge.meet1 = new_meet;
+	if( op->u.meet_merge.meet2 == old_meet )
+	  op->u.meet_merge.meet2 = new_meet;
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_ASSIGN:
+
+	if( op->u.meet_assign.meet == old_meet )
+	  op->u.meet_assign.meet = new_meet;
+	if( op->u.meet_assign.target_meet == old_meet )
+	  op->u.meet_assign.target_meet = new_meet;
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_UNASSIGN:
+
+	if( op->u.meet_unassign.meet == old_meet )
+	  op->u.meet_unassign.meet = new_meet;
+	if( op->u.meet_unassign.target_meet == old_meet )
+	  op->u.meet_unassign.target_meet = new_meet;
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_SET_DOMAIN:
+
+	if( op->u.meet_set_domain.meet == old_meet )
+	  op->u.meet_set_domain.meet = new_meet;
+	break;
+
+      default:
+
+	break;
+    }
+  }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionReplaceTask(KHE_TRANSACTION t, KHE_TASK old_task,     */
+/*    KHE_TASK new_task)                                                     */
+/*                                                                           */
+/*  Replace old_task by new_task in every operation recorded so far in t,    */
+/*  including the tasks of the meet merges.                                  */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionReplaceTask(KHE_TRANSACTION t, KHE_TASK old_task,
+  KHE_TASK new_task)
+{
+  KHE_TRANSACTION_OP op;  int i;
+  for( i = 0;  i < t->operations_count;  i++ )
+  {
+    op = MArrayGet(t->operations, i);
+    switch( op->type )
+    {
+      case KHE_TRANSACTION_OP_TASK_MAKE:
+
+	if( op->u.task_make.res == old_task )
+	  op->u.task_make.res = new_task;
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_ASSIGN:
+
+	if( op->u.task_assign.task == old_task )
+	  op->u.task_assign.task = new_task;
+	if( op->u.task_assign.target_task == old_task )
+	  op->u.task_assign.target_task = new_task;
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_UNASSIGN:
+
+	if( op->u.task_unassign.task == old_task )
+	  op->u.task_unassign.task = new_task;
+	if( op->u.task_unassign.target_task == old_task )
+	  op->u.task_unassign.target_task = new_task;
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_SET_DOMAIN:
+
+	if( op->u.task_set_domain.task == old_task )
+	  op->u.task_set_domain.task = new_task;
+	break;
+
+      default:
+
+	break;
+    }
+  }
+  for( i = 0;  i < MArraySize(t->merge_tasks);  i++ )
+    if( MArrayGet(t->merge_tasks, i) == old_task )
+      MArrayPut(t->merge_tasks, i, new_task);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionLog(KHE_TRANSACTION t, KHE_LOG_CODE code,             */
+/*    int count, int a1, int a2, int a3)                                     */
+/*                                                                           */
+/*  If t is logging, append code and the first count of a1, a2, and a3 to    */
+/*  its log.                                                                 */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionLog(KHE_TRANSACTION t, KHE_LOG_CODE code,
+  int count, int a1, int a2, int a3)
+{
+  if( t->logging )
+  {
+    MArrayAddLast(t->log, code);
+    if( count >= 1 )  MArrayAddLast(t->log, a1);
+    if( count >= 2 )  MArrayAddLast(t->log, a2);
+    if( count >= 3 )  MArrayAddLast(t->log, a3);
+  }
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheTransactionOpMeetMake(KHE_TRANSACTION t, KHE_MEET res)           */
@@ -281,6 +569,7 @@ static KHE_TRANSACTION_OP GetOp(KHE_TRANSACTION t)
 void KheTransactionOpMeetMake(KHE_TRANSACTION t, KHE_MEET res)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_MEET_MAKE;
   op->u.meet_make.res = res;
@@ -299,6 +588,7 @@ void KheTransactionOpMeetMake(KHE_TRANSACTION t, KHE_MEET res)
 void KheTransactionOpMeetDelete(KHE_TRANSACTION t)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_MEET_DELETE;
   t->may_undo = false;
@@ -319,6 +609,8 @@ void KheTransactionOpMeetSplit(KHE_TRANSACTION t, KHE_MEET meet1,
   KHE_MEET meet2)
 {
   KHE_TRANSACTION_OP op;
+  KheTransactionLog(t, KHE_LOG_MEET_SPLIT, 2, KheMeetIndex(meet1),
+    KheMeetDuration(meet1), 0);
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_MEET_SPLIT;
   op->u.meet_split.meet1 = meet1;
@@ -329,22 +621,73 @@ void KheTransactionOpMeetSplit(KHE_TRANSACTION t, KHE_MEET meet1,
 
 /*****************************************************************************/
 /*                                                                           */
-/*  void KheTransactionOpMeetMerge(KHE_TRANSACTION t)                        */
+/*  void KheTransactionOpMeetMerge(KHE_TRANSACTION t, KHE_MEET meet1,        */
+/*    KHE_MEET meet2)                                                        */
 /*                                                                           */
-/*  Add a record of a call to KheMeetMerge to t.                             */
+/*  Add a record of a call to KheMeetMerge to t.  This is called before      */
+/*  anything changes, so meet1's duration is still the split point and       */
+/*  meet2's index is the one it will leave behind.  meet2's domain is kept   */
+/*  too, since splitting meet1 again gives meet2 a domain derived from       */
+/*  meet1's.  meet2 is about to be freed, so from here on t refers to it     */
+/*  by a placeholder.                                                        */
 /*                                                                           */
 /*****************************************************************************/
 
-void KheTransactionOpMeetMerge(KHE_TRANSACTION t)
+void KheTransactionOpMeetMerge(KHE_TRANSACTION t, KHE_MEET meet1,
+  KHE_MEET meet2)
 {
-  KHE_TRANSACTION_OP op;
+  KHE_TRANSACTION_OP op;  KHE_MEET placeholder;
+  KheTransactionLog(t, KHE_LOG_MEET_MERGE, 2, KheMeetIndex(meet1),
+    KheMeetIndex(meet2), 0);
+  placeholder = (KHE_MEET) GetPlaceholder(t);
+  KheTransactionReplaceMeet(t, meet2, placeholder);
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_MEET_MERGE;
-  t->may_undo = false;
+  op->u.meet_merge.meet1 = meet1;
+  op->u.meet_merge.meet2 = placeholder;
+  op->u.meet_merge.meet2_index = KheMeetIndex(meet2);
+  op->u.meet_merge.duration1 = KheMeetDuration(meet1);
+  op->u.meet_merge.domain2 = KheMeetDomain(meet2);
+  op->u.meet_merge.task_count = 0;
+  op->u.meet_merge.first_task = MArraySize(t->merge_tasks);
+  op->u.meet_merge.first_int = MArraySize(t->merge_ints);
   t->may_redo = false;
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionOpMeetMergeTask(KHE_TRANSACTION t, KHE_TASK task1,    */
+/*    KHE_TASK task2)                                                        */
+/*                                                                           */
+/*  Add to the meet merge just recorded in t the merge of task2 into task1.  */
+/*  This is called just before task2 is deleted, so its index is the one     */
+/*  it will leave behind.  As for meet2, t refers to task2 by a placeholder  */
+/*  from here on.                                                            */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheTransactionOpMeetMergeTask(KHE_TRANSACTION t, KHE_TASK task1,
+  KHE_TASK task2)
+{
+  KHE_TRANSACTION_OP op;  KHE_TASK placeholder;  int i;
+  MAssert(t->operations_count > 0,
+    "KheTransactionOpMeetMergeTask internal error");
+  op = MArrayGet(t->operations, t->operations_count - 1);
+  MAssert(op->type == KHE_TRANSACTION_OP_MEET_MERGE,
+    "KheTransactionOpMeetMergeTask internal error");
+  placeholder = (KHE_TASK) GetPlaceholder(t);
+  KheTransactionReplaceTask(t, task2, placeholder);
+  MArrayAddLast(t->merge_tasks, task1);
+  MArrayAddLast(t->merge_tasks, placeholder);
+  for( i = 0;  i < KheTaskAssignedToCount(task2);  i++ )
+    MArrayAddLast(t->merge_tasks, KheTaskAssignedTo(task2, i));
+  MArrayAddLast(t->merge_ints, KheTaskIndexInSoln(task2));
+  MArrayAddLast(t->merge_ints, KheTaskAssignedToCount(task2));
+  op->u.meet_merge.task_count++;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheTransactionOpMeetAssign(KHE_TRANSACTION t,                       */
@@ -358,6 +701,8 @@ void KheTransactionOpMeetAssign(KHE_TRANSACTION t,
   KHE_MEET meet, KHE_MEET target_meet, int target_offset)
 {
   KHE_TRANSACTION_OP op;
+  KheTransactionLog(t, KHE_LOG_MEET_ASSIGN, 3, KheMeetIndex(meet),
+    KheMeetIndex(target_meet), target_offset);
 
   /* first check whether this new op cancels the immediately preceding op */
   if( t->operations_count > 0 )
@@ -396,6 +741,7 @@ void KheTransactionOpMeetUnAssign(KHE_TRANSACTION t,
   KHE_MEET meet, KHE_MEET target_meet, int target_offset)
 {
   KHE_TRANSACTION_OP op;
+  KheTransactionLog(t, KHE_LOG_MEET_UNASSIGN, 1, KheMeetIndex(meet), 0, 0);
 
   /* first check whether this new op cancels the immediately preceding op */
   if( t->operations_count > 0 )
@@ -453,6 +799,7 @@ void KheTransactionOpMeetSetDomain(KHE_TRANSACTION t,
   KHE_MEET meet, KHE_TIME_GROUP old_tg, KHE_TIME_GROUP new_tg)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
 
   /* first check whether this new op is mergeable with the preceding op */
   if( t->operations_count > 0 )
@@ -495,6 +842,7 @@ void KheTransactionOpMeetSetDomain(KHE_TRANSACTION t,
 void KheTransactionOpTaskMake(KHE_TRANSACTION t, KHE_TASK res)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
 
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_TASK_MAKE;
@@ -514,6 +862,7 @@ void KheTransactionOpTaskMake(KHE_TRANSACTION t, KHE_TASK res)
 void KheTransactionOpTaskDelete(KHE_TRANSACTION t)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
 
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_TASK_DELETE;
@@ -535,6 +884,8 @@ void KheTransactionOpTaskAssign(KHE_TRANSACTION t, KHE_TASK task,
   KHE_TASK target_task)
 {
   KHE_TRANSACTION_OP op;
+  KheTransactionLog(t, KHE_LOG_TASK_ASSIGN, 2, KheTaskIndexInSoln(task),
+    KheTaskIndexInSoln(target_task), 0);
 
   /* first check whether this new op cancels the immediately preceding op */
   if( t->operations_count > 0 )
@@ -571,6 +922,8 @@ void KheTransactionOpTaskUnAssign(KHE_TRANSACTION t, KHE_TASK task,
   KHE_TASK target_task)
 {
   KHE_TRANSACTION_OP op;
+  KheTransactionLog(t, KHE_LOG_TASK_UNASSIGN, 1, KheTaskIndexInSoln(task),
+    0, 0);
 
   /* first check whether this new op cancels the immediately preceding op */
   if( t->operations_count > 0 )
@@ -608,6 +961,7 @@ void KheTransactionOpTaskSetDomain(KHE_TRANSACTION t, KHE_TASK task,
   KHE_RESOURCE_GROUP old_rg, KHE_RESOURCE_GROUP new_rg)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
 
   /* first check whether this new op is mergeable with the preceding op */
   if( t->operations_count > 0 )
@@ -652,6 +1006,7 @@ void KheTransactionOpNodeAddParent(KHE_TRANSACTION t,
   KHE_NODE child_node, KHE_NODE parent_node)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
 
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_NODE_ADD_PARENT;
@@ -673,6 +1028,7 @@ void KheTransactionOpNodeDeleteParent(KHE_TRANSACTION t,
   KHE_NODE child_node, KHE_NODE parent_node)
 {
   KHE_TRANSACTION_OP op;
+  t->log_portable = false;
 
   op = GetOp(t);
   op->type = KHE_TRANSACTION_OP_NODE_DELETE_PARENT;
@@ -687,6 +1043,243 @@ void KheTransactionOpNodeDeleteParent(KHE_TRANSACTION t,
 /*                                                                           */
 /*****************************************************************************/
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSubstituteMeet(KHE_MEET *meet, KHE_MEET old_meet,                */
+/*    KHE_MEET new_meet)                                                     */
+/*                                                                           */
+/*  If *meet is old_meet, change it to new_meet.                             */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheSubstituteMeet(KHE_MEET *meet, KHE_MEET old_meet,
+  KHE_MEET new_meet)
+{
+  if( *meet == old_meet )
+    *meet = new_meet;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheSubstituteTask(KHE_TASK *task, ARRAY_KHE_TASK *old_tasks,        */
+/*    ARRAY_KHE_TASK *new_tasks)                                             */
+/*                                                                           */
+/*  If *task is one of old_tasks, change it to the corresponding new task.   */
+/*  NULL entries of old_tasks are tasks that no longer need substituting.    */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheSubstituteTask(KHE_TASK *task, ARRAY_KHE_TASK *old_tasks,
+  ARRAY_KHE_TASK *new_tasks)
+{
+  KHE_TASK old_task;  int i;
+  MArrayForEach(*old_tasks, &old_task, &i)
+    if( old_task != NULL && *task == old_task )
+    {
+      *task = MArrayGet(*new_tasks, i);
+      return;
+    }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionSubstitute(KHE_TRANSACTION t, int pos,                */
+/*    KHE_MEET old_meet, KHE_MEET new_meet, ARRAY_KHE_TASK *old_tasks,       */
+/*    ARRAY_KHE_TASK *new_tasks)                                             */
+/*                                                                           */
+/*  Undoing the merge recorded at pos has recreated old_meet and old_tasks   */
+/*  as new_meet and new_tasks.  Change the operations before pos to refer    */
+/*  to the new objects, stopping at the operation that created each old one  */
+/*  (before that, its address may have belonged to something else).          */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionSubstitute(KHE_TRANSACTION t, int pos,
+  KHE_MEET old_meet, KHE_MEET new_meet, ARRAY_KHE_TASK *old_tasks,
+  ARRAY_KHE_TASK *new_tasks)
+{
+  KHE_TRANSACTION_OP op;  KHE_TASK task;  int i, j, k;  bool created;
+  created = false;
+  for( i = pos - 1;  i >= 0 && !created;  i-- )
+  {
+    op = MArrayGet(t->operations, i);
+    switch( op->type )
+    {
+      case KHE_TRANSACTION_OP_MEET_MAKE:
+
+	created = (op->u.meet_make.res == old_meet);
+	KheSubstituteMeet(&op->u.meet_make.res, old_meet, new_meet);
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_DELETE:
+
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_SPLIT:
+
+	/* old_meet and its tasks were created by this split */
+	created = (op->u.meet_split.meet2 == old_meet);
+	KheSubstituteMeet(&op->u.meet_split.meet1, old_meet, new_meet);
+	KheSubstituteMeet(&op->u.meet_split.meet2, old_meet, new_meet);
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_MERGE:
+
+	KheSubstituteMeet(&op->u.meet_merge.meet1, old_meet, new_meet);
+	KheSubstituteMeet(&op->u.meet_merge.meet2, old_meet, new_meet);
+	k = op->u.meet_merge.first_task;
+	for( j = 0;  j < op->u.meet_merge.task_count;  j++ )
+	  k += 2 + MArrayGet(t->merge_ints, op->u.meet_merge.first_int + 2*j + 1);
+	for( j = op->u.meet_merge.first_task;  j < k;  j++ )
+	{
+	  task = MArrayGet(t->merge_tasks, j);
+	  KheSubstituteTask(&task, old_tasks, new_tasks);
+	  MArrayPut(t->merge_tasks, j, task);
+	}
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_ASSIGN:
+
+	KheSubstituteMeet(&op->u.meet_assign.meet, old_meet, new_meet);
+	KheSubstituteMeet(&op->u.meet_assign.target_meet, old_meet, new_meet);
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_UNASSIGN:
+
+	KheSubstituteMeet(&op->u.meet_unassign.meet, old_meet, new_meet);
+	KheSubstituteMeet(&op->u.meet_unassign.target_meet, old_meet,
+	  new_meet);
+	break;
+
+      case KHE_TRANSACTION_OP_MEET_SET_DOMAIN:
+
+	KheSubstituteMeet(&op->u.meet_set_domain.meet, old_meet, new_meet);
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_MAKE:
+
+	/* the old task was made here; forget it for earlier operations */
+	MArrayForEach(*old_tasks, &task, &j)
+	  if( op->u.task_make.res == task )
+	  {
+	    op->u.task_make.res = MArrayGet(*new_tasks, j);
+	    MArrayPut(*old_tasks, j, NULL);
+	    break;
+	  }
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_DELETE:
+
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_ASSIGN:
+
+	KheSubstituteTask(&op->u.task_assign.task, old_tasks, new_tasks);
+	KheSubstituteTask(&op->u.task_assign.target_task, old_tasks,
+	  new_tasks);
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_UNASSIGN:
+
+	KheSubstituteTask(&op->u.task_unassign.task, old_tasks, new_tasks);
+	KheSubstituteTask(&op->u.task_unassign.target_task, old_tasks,
+	  new_tasks);
+	break;
+
+      case KHE_TRANSACTION_OP_TASK_SET_DOMAIN:
+
+	KheSubstituteTask(&op->u.task_set_domain.task, old_tasks, new_tasks);
+	break;
+
+      case KHE_TRANSACTION_OP_NODE_ADD_PARENT:
+      case KHE_TRANSACTION_OP_NODE_DELETE_PARENT:
+
+	break;
+
+      default:
+
+	MAssert(false, "KheTransactionSubstitute internal error");
+	break;
+    }
+  }
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionUndoMeetMerge(KHE_TRANSACTION t, int pos)             */
+/*                                                                           */
+/*  Undo the meet merge recorded at pos in t.  Splitting meet1 again gives   */
+/*  back meet2 and its tasks as new objects; they are returned to the        */
+/*  indexes in soln that the merge took from them, they get back the tasks   */
+/*  that were assigned to them, and the earlier operations of t are changed  */
+/*  to refer to them.                                                        */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionUndoMeetMerge(KHE_TRANSACTION t, int pos)
+{
+  KHE_TRANSACTION_OP op;  KHE_MEET meet1, meet2;  KHE_TASK task1, task;
+  ARRAY_KHE_TASK old_tasks, new_tasks;  int i, j, k, end, child_count;
+  op = MArrayGet(t->operations, pos);
+  if( !KheMeetSplit(op->u.meet_merge.meet1, op->u.meet_merge.duration1,
+	false, &meet1, &meet2) )
+    MAssert(false, "KheTransactionUndo: failed to undo KheMeetMerge");
+  KheSolnSwapMeets(t->soln, op->u.meet_merge.meet2_index,
+    KheMeetIndex(meet2));
+  if( KheMeetDomain(meet2) != op->u.meet_merge.domain2 &&
+      !KheMeetSetDomain(meet2, op->u.meet_merge.domain2) )
+    MAssert(false, "KheTransactionUndo: failed to undo KheMeetMerge");
+
+  /* the split puts the fragment of meet1's i'th task at meet2's i'th */
+  MArrayInit(old_tasks);
+  MArrayInit(new_tasks);
+  k = op->u.meet_merge.first_task;
+  for( j = 0;  j < op->u.meet_merge.task_count;  j++ )
+  {
+    task1 = MArrayGet(t->merge_tasks, k);
+    for( i = 0;  KheMeetTask(meet1, i) != task1;  i++ )
+      MAssert(i < KheMeetTaskCount(meet1) - 1,
+	"KheTransactionUndo: lost task while undoing KheMeetMerge");
+    MArrayAddLast(old_tasks, MArrayGet(t->merge_tasks, k + 1));
+    MArrayAddLast(new_tasks, KheMeetTask(meet2, i));
+    k += 2 + MArrayGet(t->merge_ints, op->u.meet_merge.first_int + 2*j + 1);
+  }
+
+  /* undo the task deletions in reverse order: each deletion moved the */
+  /* last task into the hole, so append the task and swap it back */
+  end = KheSolnTaskCount(t->soln) - op->u.meet_merge.task_count;
+  for( j = op->u.meet_merge.task_count - 1;  j >= 0;  j-- )
+  {
+    task = MArrayGet(new_tasks, j);
+    KheSolnSwapTasks(t->soln, end, KheTaskIndexInSoln(task));
+    KheSolnSwapTasks(t->soln,
+      MArrayGet(t->merge_ints, op->u.meet_merge.first_int + 2*j), end);
+    end++;
+  }
+
+  /* return the tasks that were assigned to each old task2 */
+  k = op->u.meet_merge.first_task;
+  for( j = 0;  j < op->u.meet_merge.task_count;  j++ )
+  {
+    child_count =
+      MArrayGet(t->merge_ints, op->u.meet_merge.first_int + 2*j + 1);
+    for( i = 0;  i < child_count;  i++ )
+      if( !KheTaskMove(MArrayGet(t->merge_tasks, k + 2 + i),
+	    MArrayGet(new_tasks, j)) )
+	MAssert(false, "KheTransactionUndo: failed to undo KheMeetMerge");
+    k += 2 + child_count;
+  }
+  KheSolnAssignHashReset(t->soln);
+
+  KheTransactionSubstitute(t, pos, op->u.meet_merge.meet2, meet2,
+    &old_tasks, &new_tasks);
+  MArrayFree(old_tasks);
+  MArrayFree(new_tasks);
+}
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheTransactionUndo(KHE_TRANSACTION t)                               */
@@ -702,6 +1295,7 @@ void KheTransactionUndo(KHE_TRANSACTION t)
     "KheTransactionUndo called before KheTransactionMakeEnd");
   MAssert(t->may_undo,
     "KheTransactionUndo prevented by unsuitable operations");
+  KheSolnBeginBatch(t->soln);
   for( i = t->operations_count - 1;  i >= 0;  i-- )
   {
     op = MArrayGet(t->operations, i);
@@ -726,7 +1320,7 @@ void KheTransactionUndo(KHE_TRANSACTION t)
 
       case KHE_TRANSACTION_OP_MEET_MERGE:
 
-	MAssert(false, "KheTransactionUndo internal error (meet merge)");
+	KheTransactionUndoMeetMerge(t, i);
 	break;
 
       case KHE_TRANSACTION_OP_MEET_ASSIGN:
@@ -798,6 +1392,7 @@ void KheTransactionUndo(KHE_TRANSACTION t)
 	break;
     }
   }
+  KheSolnEndBatch(t->soln);
 }
 
 
@@ -816,6 +1411,7 @@ void KheTransactionRedo(KHE_TRANSACTION t)
     "KheTransactionRedo called before KheTransactionMakeEnd");
   MAssert(t->may_redo,
     "KheTransactionRedo prevented by unsuitable operations");
+  KheSolnBeginBatch(t->soln);
   for( i = 0;  i < t->operations_count;  i++ )
   {
     op = MArrayGet(t->operations, i);
@@ -908,6 +1504,41 @@ void KheTransactionRedo(KHE_TRANSACTION t)
 	break;
     }
   }
+  KheSolnEndBatch(t->soln);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionCopyMeetMerge(KHE_TRANSACTION src_t,                  */
+/*    KHE_TRANSACTION_OP op, KHE_TRANSACTION dst_t)                          */
+/*                                                                           */
+/*  Copy meet merge op of src_t onto the end of dst_t, with its tasks.       */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionCopyMeetMerge(KHE_TRANSACTION src_t,
+  KHE_TRANSACTION_OP op, KHE_TRANSACTION dst_t)
+{
+  KHE_TRANSACTION_OP dst_op;  int i, j, k, child_count;
+  dst_op = GetOp(dst_t);
+  dst_op->type = KHE_TRANSACTION_OP_MEET_MERGE;
+  dst_op->u.meet_merge = op->u.meet_merge;
+  dst_op->u.meet_merge.first_task = MArraySize(dst_t->merge_tasks);
+  dst_op->u.meet_merge.first_int = MArraySize(dst_t->merge_ints);
+  k = op->u.meet_merge.first_task;
+  for( j = 0;  j < op->u.meet_merge.task_count;  j++ )
+  {
+    MArrayAddLast(dst_t->merge_ints,
+      MArrayGet(src_t->merge_ints, op->u.meet_merge.first_int + 2*j));
+    child_count =
+      MArrayGet(src_t->merge_ints, op->u.meet_merge.first_int + 2*j + 1);
+    MArrayAddLast(dst_t->merge_ints, child_count);
+    for( i = 0;  i < 2 + child_count;  i++ )
+      MArrayAddLast(dst_t->merge_tasks, MArrayGet(src_t->merge_tasks, k + i));
+    k += 2 + child_count;
+  }
+  dst_t->may_redo = false;
 }
 
 
@@ -946,7 +1577,7 @@ void KheTransactionCopy(KHE_TRANSACTION src_t, KHE_TRANSACTION dst_t)
 
       case KHE_TRANSACTION_OP_MEET_MERGE:
 
-	KheTransactionOpMeetMerge(dst_t);
+	KheTransactionCopyMeetMerge(src_t, op, dst_t);
 	break;
 
       case KHE_TRANSACTION_OP_MEET_ASSIGN:
@@ -1018,6 +1649,210 @@ void KheTransactionCopy(KHE_TRANSACTION src_t, KHE_TRANSACTION dst_t)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  Submodule "logs"                                                         */
+/*                                                                           */
+/*****************************************************************************/
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionSetLogging(KHE_TRANSACTION t, bool logging)           */
+/*                                                                           */
+/*  Set whether t keeps a log of the operations it records.  The log is      */
+/*  cleared by KheTransactionBegin, so this is usually called before that.   */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheTransactionSetLogging(KHE_TRANSACTION t, bool logging)
+{
+  t->logging = logging;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheTransactionLogPortable(KHE_TRANSACTION t)                        */
+/*                                                                           */
+/*  Return true if every operation recorded by t has gone into its log, so   */
+/*  that the log can be replayed onto another soln.                          */
+/*                                                                           */
+/*****************************************************************************/
+
+bool KheTransactionLogPortable(KHE_TRANSACTION t)
+{
+  return t->logging && t->log_portable;
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  int KheTransactionLogLength(KHE_TRANSACTION t)                           */
+/*                                                                           */
+/*  Return the number of integers in t's log.                                */
+/*                                                                           */
+/*****************************************************************************/
+
+int KheTransactionLogLength(KHE_TRANSACTION t)
+{
+  return MArraySize(t->log);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionLogExport(KHE_TRANSACTION t, int *log)                */
+/*                                                                           */
+/*  Copy t's log into log, which must have room for KheTransactionLogLength  */
+/*  integers.  The copy refers to nothing in t's soln, so it may be handed   */
+/*  to another thread and replayed there by KheSolnReplayLog.                */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheTransactionLogExport(KHE_TRANSACTION t, int *log)
+{
+  int i;
+  for( i = 0;  i < MArraySize(t->log);  i++ )
+    log[i] = MArrayGet(t->log, i);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionLogMeetSwap(KHE_TRANSACTION t, int index1,            */
+/*    int index2)                                                            */
+/*                                                                           */
+/*  Add to t's log a swap of the meets at index1 and index2 of the soln.     */
+/*  Such swaps are made only when undoing a meet merge; they are not         */
+/*  operations of t, but they do change what the indexes refer to.           */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheTransactionLogMeetSwap(KHE_TRANSACTION t, int index1, int index2)
+{
+  KheTransactionLog(t, KHE_LOG_MEET_SWAP, 2, index1, index2, 0);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionLogTaskSwap(KHE_TRANSACTION t, int index1,            */
+/*    int index2)                                                            */
+/*                                                                           */
+/*  Like KheTransactionLogMeetSwap, only for tasks.                          */
+/*                                                                           */
+/*****************************************************************************/
+
+void KheTransactionLogTaskSwap(KHE_TRANSACTION t, int index1, int index2)
+{
+  KheTransactionLog(t, KHE_LOG_TASK_SWAP, 2, index1, index2, 0);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  bool KheSolnReplayLog(KHE_SOLN soln, int *log, int len)                  */
+/*                                                                           */
+/*  Replay onto soln the len integers of log, exported from a transaction    */
+/*  whose soln had the same meets and tasks at the same indexes as soln      */
+/*  has now (a KheSolnCopy, say).  Return false if some entry is malformed   */
+/*  or its operation fails; the entries before it remain applied.            */
+/*                                                                           */
+/*****************************************************************************/
+
+#define KheLogMeetOk(soln, i) ((i) >= 0 && (i) < KheSolnMeetCount(soln))
+#define KheLogTaskOk(soln, i) ((i) >= 0 && (i) < KheSolnTaskCount(soln))
+
+bool KheSolnReplayLog(KHE_SOLN soln, int *log, int len)
+{
+  int i, a1, a2, a3;  bool res, swapped;  KHE_MEET junk1, junk2;
+  res = true;  swapped = false;
+  KheSolnBeginBatch(soln);
+  for( i = 0;  res && i < len;  )
+  {
+    a1 = i + 1 < len ? log[i + 1] : -1;
+    a2 = i + 2 < len ? log[i + 2] : -1;
+    a3 = i + 3 < len ? log[i + 3] : -1;
+    switch( log[i] )
+    {
+      case KHE_LOG_MEET_SPLIT:
+
+	res = i + 2 < len && KheLogMeetOk(soln, a1) &&
+	  KheMeetSplit(KheSolnMeet(soln, a1), a2, false, &junk1, &junk2);
+	i += 3;
+	break;
+
+      case KHE_LOG_MEET_MERGE:
+
+	res = i + 2 < len && KheLogMeetOk(soln, a1) &&
+	  KheLogMeetOk(soln, a2) &&
+	  KheMeetMerge(KheSolnMeet(soln, a1), KheSolnMeet(soln, a2), &junk1);
+	i += 3;
+	break;
+
+      case KHE_LOG_MEET_ASSIGN:
+
+	res = i + 3 < len && KheLogMeetOk(soln, a1) &&
+	  KheLogMeetOk(soln, a2) &&
+	  KheMeetAssign(KheSolnMeet(soln, a1), KheSolnMeet(soln, a2), a3);
+	i += 4;
+	break;
+
+      case KHE_LOG_MEET_UNASSIGN:
+
+	res = i + 1 < len && KheLogMeetOk(soln, a1) &&
+	  KheMeetAsst(KheSolnMeet(soln, a1)) != NULL;
+	if( res )
+	  KheMeetUnAssign(KheSolnMeet(soln, a1));
+	i += 2;
+	break;
+
+      case KHE_LOG_MEET_SWAP:
+
+	res = i + 2 < len && KheLogMeetOk(soln, a1) && KheLogMeetOk(soln, a2);
+	if( res )
+	  KheSolnSwapMeets(soln, a1, a2), swapped = true;
+	i += 3;
+	break;
+
+      case KHE_LOG_TASK_ASSIGN:
+
+	res = i + 2 < len && KheLogTaskOk(soln, a1) &&
+	  KheLogTaskOk(soln, a2) &&
+	  KheTaskAssign(KheSolnTask(soln, a1), KheSolnTask(soln, a2));
+	i += 3;
+	break;
+
+      case KHE_LOG_TASK_UNASSIGN:
+
+	res = i + 1 < len && KheLogTaskOk(soln, a1) &&
+	  KheTaskAsst(KheSolnTask(soln, a1)) != NULL;
+	if( res )
+	  KheTaskUnAssign(KheSolnTask(soln, a1));
+	i += 2;
+	break;
+
+      case KHE_LOG_TASK_SWAP:
+
+	res = i + 2 < len && KheLogTaskOk(soln, a1) && KheLogTaskOk(soln, a2);
+	if( res )
+	  KheSolnSwapTasks(soln, a1, a2), swapped = true;
+	i += 3;
+	break;
+
+      default:
+
+	res = false;
+	break;
+    }
+  }
+  if( swapped )
+    KheSolnAssignHashReset(soln);
+  KheSolnEndBatch(soln);
+  return res;
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  Submodule "debug"                                                        */
@@ -1026,15 +1861,50 @@ void KheTransactionCopy(KHE_TRANSACTION src_t, KHE_TRANSACTION dst_t)
 
 /*****************************************************************************/
 /*                                                                           */
-/*  void KheTransactionOpDebug(KHE_TRANSACTION_OP op,                        */
+/*  void KheTransactionMeetDebug(KHE_TRANSACTION t, KHE_MEET meet, FILE *fp) */
+/*                                                                           */
+/*  Print meet, mentioned by t, onto fp; a placeholder is printed as "-".    */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionMeetDebug(KHE_TRANSACTION t, KHE_MEET meet,
+  FILE *fp)
+{
+  if( KheTransactionIsPlaceholder(t, (void *) meet) )
+    fprintf(fp, "-");
+  else
+    KheMeetDebug(meet, 1, -1, fp);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionTaskDebug(KHE_TRANSACTION t, KHE_TASK task, FILE *fp) */
+/*                                                                           */
+/*  Print task, mentioned by t, onto fp; a placeholder is printed as "-".    */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTransactionTaskDebug(KHE_TRANSACTION t, KHE_TASK task,
+  FILE *fp)
+{
+  if( KheTransactionIsPlaceholder(t, (void *) task) )
+    fprintf(fp, "-");
+  else
+    KheTaskDebug(task, 1, -1, fp);
+}
+
+
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTransactionOpDebug(KHE_TRANSACTION t, KHE_TRANSACTION_OP op,     */
 /*    int verbosity, FILE *fp)                                               */
 /*                                                                           */
-/*  Print one transaction op onto fp with the given verbosity and no extra   */
-/*  space.                                                                   */
+/*  Print one op of t onto fp with the given verbosity and no extra space.   */
 /*                                                                           */
 /*****************************************************************************/
 
-static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
+static void KheTransactionOpDebug(KHE_TRANSACTION t, KHE_TRANSACTION_OP op,
   int verbosity, FILE *fp)
 {
   switch( op->type )
@@ -1043,7 +1913,7 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
 
       if( verbosity >= 2 )
       {
-	KheMeetDebug(op->u.meet_make.res, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_make.res, fp);
 	fprintf(fp, " = ");
       }
       fprintf(fp, "KheMeetMake");
@@ -1064,9 +1934,9 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(-, -, ");
-	KheMeetDebug(op->u.meet_split.meet1, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_split.meet1, fp);
 	fprintf(fp, ", ");
-	KheMeetDebug(op->u.meet_split.meet2, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_split.meet2, fp);
 	fprintf(fp, ")");
       }
       break;
@@ -1075,7 +1945,13 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
 
       fprintf(fp, "MeetMerge");
       if( verbosity >= 2 )
-	fprintf(fp, "(-, -, -)");
+      {
+	fprintf(fp, "(");
+	KheTransactionMeetDebug(t, op->u.meet_merge.meet1, fp);
+	fprintf(fp, ", ");
+	KheTransactionMeetDebug(t, op->u.meet_merge.meet2, fp);
+	fprintf(fp, ", -)");
+      }
       break;
 
     case KHE_TRANSACTION_OP_MEET_ASSIGN:
@@ -1084,9 +1960,9 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(");
-	KheMeetDebug(op->u.meet_assign.meet, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_assign.meet, fp);
 	fprintf(fp, ", ");
-	KheMeetDebug(op->u.meet_assign.target_meet, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_assign.target_meet, fp);
 	fprintf(fp, ", %d)", op->u.meet_assign.target_offset);
       }
       break;
@@ -1097,9 +1973,9 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(");
-	KheMeetDebug(op->u.meet_assign.meet, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_assign.meet, fp);
 	fprintf(fp, ") was (");
-	KheMeetDebug(op->u.meet_assign.target_meet, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_assign.target_meet, fp);
 	fprintf(fp, ", %d)", op->u.meet_assign.target_offset);
       }
       break;
@@ -1110,7 +1986,7 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(");
-	KheMeetDebug(op->u.meet_set_domain.meet, 1, -1, fp);
+	KheTransactionMeetDebug(t, op->u.meet_set_domain.meet, fp);
 	fprintf(fp, ", td)");
       }
       break;
@@ -1119,7 +1995,7 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
 
       if( verbosity >= 2 )
       {
-	KheTaskDebug(op->u.task_make.res, 1, -1, fp);
+	KheTransactionTaskDebug(t, op->u.task_make.res, fp);
 	fprintf(fp, " = ");
       }
       fprintf(fp, "KheTaskMake");
@@ -1140,9 +2016,9 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(");
-	KheTaskDebug(op->u.task_assign.task, 1, -1, fp);
+	KheTransactionTaskDebug(t, op->u.task_assign.task, fp);
 	fprintf(fp, ", ");
-	KheTaskDebug(op->u.task_assign.target_task, 1, -1, fp);
+	KheTransactionTaskDebug(t, op->u.task_assign.target_task, fp);
 	fprintf(fp, ")");
       }
       break;
@@ -1153,9 +2029,9 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(");
-	KheTaskDebug(op->u.task_unassign.task, 1, -1, fp);
+	KheTransactionTaskDebug(t, op->u.task_unassign.task, fp);
 	fprintf(fp, ") was ");
-	KheTaskDebug(op->u.task_unassign.target_task, 1, -1, fp);
+	KheTransactionTaskDebug(t, op->u.task_unassign.target_task, fp);
       }
       break;
 
@@ -1165,7 +2041,7 @@ static void KheTransactionOpDebug(KHE_TRANSACTION_OP op,
       if( verbosity >= 2 )
       {
 	fprintf(fp, "(");
-	KheTaskDebug(op->u.task_set_domain.task, 1, -1, fp);
+	KheTransactionTaskDebug(t, op->u.task_set_domain.task, fp);
 	fprintf(fp, ", ");
 	KheResourceGroupDebug(op->u.task_set_domain.new_rg, 1, -1, fp);
 	fprintf(fp, ") was ");
@@ -1248,7 +2124,7 @@ void KheTransactionDebug(KHE_TRANSACTION t, int verbosity,
 	fprintf(fp, ", ");
       else
 	fprintf(fp, " ");
-      KheTransactionOpDebug(op, verbosity, fp);
+      KheTransactionOpDebug(t, op, verbosity, fp);
     }
     if( indent >= 0 )
       fprintf(fp, "\n%*s]\n", indent, "");
@@ -478,6 +478,25 @@ static bool KheComponentDistinct(KHE_TWO_COMPONENT tc)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void KheTwoComponentUnAssign(KHE_TWO_COMPONENT tc)                       */
+/*                                                                           */
+/*  Ensure that all the tasks of all the nodes of tc are unassigned.         */
+/*                                                                           */
+/*  NB it is vital to deassign in reverse order, so that transactions can    */
+/*  see that previous assignments are being undone.                          */
+/*                                                                           */
+/*****************************************************************************/
+
+static void KheTwoComponentUnAssign(KHE_TWO_COMPONENT tc)
+{
+  KHE_TWO_NODE tn;  int i;
+  MArrayForEachReverse(tc->nodes, &tn, &i)
+    KheTwoNodeUnAssign(tn);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  bool KheTwoComponentAssign(KHE_TWO_COMPONENT tc, KHE_RESOURCE r1,        */
@@ -487,7 +506,9 @@ static bool KheComponentDistinct(KHE_TWO_COMPONENT tc)
 /*  successful, leave the assignments as they are and return true.           */
 /*  Otherwise return false, leaving the component unassigned.                */
 /*                                                                           */
-/*  Parameter t is a scratch transaction object.                             */
+/*  Parameter t is a scratch transaction object.  It is only used when the   */
+/*  invariant is preserved; otherwise a failed assignment is cleaned up by   */
+/*  unassigning the component.                                               */
 /*                                                                           */
 /*****************************************************************************/
 
@@ -499,30 +520,15 @@ static bool KheTwoComponentAssign(KHE_TWO_COMPONENT tc, KHE_RESOURCE r1,
   KheInvariantTransactionBegin(t, &init_count, invt);
   MArrayForEach(tc->nodes, &tn, &i)
     if( !KheTwoNodeAssign(tn, i < tc->second_start ? r1 : r2) )
+    {
+      if( !invt )
+	KheTwoComponentUnAssign(tc);
       return KheInvariantTransactionEnd(t, &init_count, invt, false);
+    }
   return KheInvariantTransactionEnd(t, &init_count, invt, true);
 }
 
 
-/*****************************************************************************/
-/*                                                                           */
-/*  void KheTwoComponentUnAssign(KHE_TWO_COMPONENT tc)                       */
-/*                                                                           */
-/*  Ensure that all the tasks of all the nodes of tc are unassigned.         */
-/*                                                                           */
-/*  NB it is vital to deassign in reverse order, so that transactions can    */
-/*  see that previous assignments are being undone.                          */
-/*                                                                           */
-/*****************************************************************************/
-
-static void KheTwoComponentUnAssign(KHE_TWO_COMPONENT tc)
-{
-  KHE_TWO_NODE tn;  int i;
-  MArrayForEachReverse(tc->nodes, &tn, &i)
-    KheTwoNodeUnAssign(tn);
-}
-
-
 /*****************************************************************************/
 /*                                                                           */
 /*  void KheTwoComponentAddAsstOption(KHE_TWO_COMPONENT tc,                  */
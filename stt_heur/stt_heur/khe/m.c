@@ -402,7 +402,10 @@ wchar_t *MWStringCopy(wchar_t *s)
 /*  setting it to 0x0, since that may cause a later retrieval to fail to     */
 /*  find other entries besides the one deleted, so 0x1 is used in this case. */
 /*                                                                           */
-/*  A symbol table object has five fields:                                   */
+/*  The size is always a power of two, so a probe sequence is a run of       */
+/*  adjacent positions starting at the hash code masked by size - 1.         */
+/*                                                                           */
+/*  A symbol table object has six fields:                                   */
 /*                                                                           */
 /*     size     Current size of the keys and values arrays                   */
 /*                                                                           */
@@ -420,6 +423,11 @@ wchar_t *MWStringCopy(wchar_t *s)
 /*              Each element is either 0x0 or 0x1, denoting a free spot,     */
 /*              or some other value, in which case it points to a key.       */
 /*                                                                           */
+/*     hashes   The hash codes of the keys, parallel to keys.  A probe       */
+/*              compares hash codes first, so strcmp is only called on       */
+/*              keys that are almost certainly equal, and a rehash does not  */
+/*              need to hash any key again.                                  */
+/*                                                                           */
 /*     values   The values, an array of any type whose length is also size.  */
 /*                                                                           */
 /*****************************************************************************/
@@ -430,20 +438,24 @@ wchar_t *MWStringCopy(wchar_t *s)
 /*                                                                           */
 /*  Return the hash code of key, before reduction modulo the table size.     */
 /*                                                                           */
-/*  Implementation note.  This hash function adds the characters together,   */
-/*  shifting each subtotal one place to the left.  If the total is negative  */
-/*  it is negated to make the result non-negative.                           */
+/*  Implementation note.  This is the FNV-1a hash followed by a final mix,   */
+/*  so that every character affects the low-order bits used by the table.    */
+/*  Ids often differ only in their last few characters, and a weaker hash    */
+/*  sends such ids into long probe sequences.  The sign bit is cleared to    */
+/*  make the result non-negative.                                            */
 /*                                                                           */
 /*****************************************************************************/
 
 int MTableHash(char *key)
 {
-  char *p;  int res;
-  res = 0;
-  for( p = key;  *p != L'\0';  p++ )
-    res = (res << 1) + *p;
-  if( res < 0 )  res = - res;
-  return res;
+  char *p;  unsigned int res;
+  res = 2166136261u;
+  for( p = key;  *p != '\0';  p++ )
+    res = (res ^ (unsigned char) *p) * 16777619u;
+  res ^= res >> 16;
+  res *= 0x85ebca6bu;
+  res ^= res >> 13;
+  return (int) (res & 0x7FFFFFFF);
 }
 
 
@@ -466,12 +478,42 @@ void MTableImplClear(MTABLE_U *table)
 }
 
 
+/*****************************************************************************/
+/*                                                                           */
+/*  void MTableImplInsertHashed(MTABLE_U *table, int hash_code, char *key)   */
+/*                                                                           */
+/*  Insert key, whose hash code is hash_code, into table and set table->pos  */
+/*  to its position in the keys array, so that the caller can insert the     */
+/*  value in a type-safe manner.  Any necessary rehash will have already     */
+/*  been done.                                                               */
+/*                                                                           */
+/*****************************************************************************/
+
+static void MTableImplInsertHashed(MTABLE_U *table, int hash_code, char *key)
+{
+  int i, mask;
+  if( DEBUG2 )
+    fprintf(stderr, "[ MTableImplInsert(%p, \"%s\")\n", (void *) table, key);
+  mask = table->size - 1;
+  i = hash_code & mask;
+  while( table->keys[i] > (char *) 0x1 )
+    i = (i + 1) & mask;
+  if( table->keys[i] == 0x0 )
+    --(table->trigger);
+  table->keys[i] = key;
+  table->hashes[i] = hash_code;
+  table->pos = i;
+  if( DEBUG2 )
+    fprintf(stderr, "] MTableImplInsert returning (pos = %d)\n", i);
+}
+
+
 /*****************************************************************************/
 /*                                                                           */
 /*  void *MTableImplCheckRehash(MTABLE_U *table, char *values)               */
 /*                                                                           */
-/*  Rehash table into just over twice as much space as it occupies now,      */
-/*  if the trigger requires it.                                              */
+/*  Rehash table into twice as much space as it occupies now, if the         */
+/*  trigger requires it.                                                     */
 /*                                                                           */
 /*  Implementation note.  Since the keys and values need to take up new      */
 /*  positions, new space for keys and values is allocated, the old keys and  */
@@ -481,22 +523,25 @@ void MTableImplClear(MTABLE_U *table)
 
 void *MTableImplCheckRehash(MTABLE_U *table, char *values)
 {
-  int i, old_size;  char *key;  char **old_keys;  char *old_values;
+  int i, old_size;  char *key;  char **old_keys;  int *old_hashes;
+  char *old_values;
   if( table->trigger <= 1 )
   {
     if( DEBUG2 )
       fprintf(stderr, "  [ MTableRehash(table %p)\n", (void *) table);
 
-    /* save old size, keys, and values */
+    /* save old size, keys, hashes, and values */
     old_size = table->size;
     old_keys = table->keys;
+    old_hashes = table->hashes;
     old_values = values;
 
     /* re-initialize table to the next larger size, all clear */
-    table->size = 2 * old_size + 5;
+    table->size = (old_size == 0 ? 8 : 2 * old_size);
     table->trigger = (4 * table->size) / 5;
     table->pos = -1;
     table->keys = (char **) calloc(table->size, sizeof(char *));
+    table->hashes = (int *) calloc(table->size, sizeof(int));
     values = (char *) calloc(table->size, table->value_size);
 
     /* insert the old keys and values into table, then free their arrays */
@@ -505,12 +550,13 @@ void *MTableImplCheckRehash(MTABLE_U *table, char *values)
       key = old_keys[i];
       if( key > (char *) 0x1 )
       {
-	MTableImplInsert(table, key);
+	MTableImplInsertHashed(table, old_hashes[i], key);
 	memcpy(&values[table->pos * table->value_size],
 	  &old_values[i * table->value_size], table->value_size);
       }
     }
     free(old_keys);
+    free(old_hashes);
     free(old_values);
 
     if( DEBUG2 )
@@ -532,18 +578,7 @@ void *MTableImplCheckRehash(MTABLE_U *table, char *values)
 
 void MTableImplInsert(MTABLE_U *table, char *key)
 {
-  int i;
-  if( DEBUG2 )
-    fprintf(stderr, "[ MTableImplInsert(%p, \"%s\")\n", (void *) table, key);
-  i = MTableHash(key) % table->size;
-  while( table->keys[i] > (char *) 0x1 )
-    i = (i + 1) % table->size;
-  if( table->keys[i] == 0x0 )
-    --(table->trigger);
-  table->keys[i] = key;
-  table->pos = i;
-  if( DEBUG2 )
-    fprintf(stderr, "] MTableImplInsert returning (pos = %d)\n", i);
+  MTableImplInsertHashed(table, MTableHash(key), key);
 }
 
 
@@ -565,12 +600,14 @@ void MTableImplInsert(MTABLE_U *table, char *key)
 
 bool MTableImplInsertUnique(MTABLE_U *table, char *key)
 {
-  int i, insert_pos;
+  int i, insert_pos, hash_code, mask;
   if( DEBUG2 )
     fprintf(stderr, "[ MTableImplInsertUnique(%p, \"%s\")\n",
       (void *) table, key);
   insert_pos = -1;
-  i = MTableHash(key) % table->size;
+  hash_code = MTableHash(key);
+  mask = table->size - 1;
+  i = hash_code & mask;
   while( table->keys[i] != 0x0 )
   {
     if( table->keys[i] == (char *) 0x1 )
@@ -578,14 +615,15 @@ bool MTableImplInsertUnique(MTABLE_U *table, char *key)
       /* not a true key; we may insert here later */
       insert_pos = i;
     }
-    else if( strcmp(key, table->keys[i]) == 0 )
+    else if( table->hashes[i] == hash_code &&
+	strcmp(key, table->keys[i]) == 0 )
     {
       table->pos = i;
       if( DEBUG2 )
 	fprintf(stderr, "] MTableImplInsertUnique ret. false (pos %d)\n", i);
       return false;
     }
-    i = (i + 1) % table->size;
+    i = (i + 1) & mask;
   }
   if( insert_pos == -1 )
   {
@@ -593,6 +631,7 @@ bool MTableImplInsertUnique(MTABLE_U *table, char *key)
     --(table->trigger);
   }
   table->keys[insert_pos] = key;
+  table->hashes[insert_pos] = hash_code;
   table->pos = insert_pos;
   if( DEBUG2 )
     fprintf(stderr, "] MTableImplInsertUnique returning true (pos %d)\n",
@@ -616,21 +655,23 @@ bool MTableImplInsertUnique(MTABLE_U *table, char *key)
 bool MTableImplContainsHashed(MTABLE_U *table, int hash_code,
   char *key, int *pos)
 {
-  int i;
+  int i, mask;
   if( DEBUG2 )
     fprintf(stderr, "[ MTableImplRetrieve(%p, %d, \"%s\")\n",
       (void *) table, hash_code, key);
-  i = hash_code % table->size;
+  mask = table->size - 1;
+  i = hash_code & mask;
   while( table->keys[i] != 0x0 )
   {
-    if( table->keys[i] > (char *) 0x1 && strcmp(key, table->keys[i]) == 0 )
+    if( table->hashes[i] == hash_code && table->keys[i] > (char *) 0x1 &&
+	strcmp(key, table->keys[i]) == 0 )
     {
       if( DEBUG2 )
 	fprintf(stderr, "] MTableImplRetrieve returning true (pos %d)\n", i);
       *pos = i;
       return true;
     }
-    i = (i + 1) % table->size;
+    i = (i + 1) & mask;
   }
   if( DEBUG2 )
     fprintf(stderr, "] MTableImplRetrieve returning false (pos %d)\n", i);
@@ -653,23 +694,26 @@ bool MTableImplContainsHashed(MTABLE_U *table, int hash_code,
 
 bool MTableImplContainsNext(MTABLE_U *table, int *pos)
 {
-  char *key;   int i;
+  char *key;   int i, mask, hash_code;
   i = *pos;
   key = table->keys[i];
+  hash_code = table->hashes[i];
   if( DEBUG2 )
     fprintf(stderr, "[ MTableImplRetrieveNext(%p, %d holding \"%s\")\n",
       (void *) table, i, key);
-  i = (i + 1) % table->size;
+  mask = table->size - 1;
+  i = (i + 1) & mask;
   while( table->keys[i] != 0x0 )
   {
-    if( table->keys[i] > (char *) 0x1 && strcmp(key, table->keys[i]) == 0 )
+    if( table->hashes[i] == hash_code && table->keys[i] > (char *) 0x1 &&
+	strcmp(key, table->keys[i]) == 0 )
     {
       if( DEBUG2 )
 	fprintf(stderr, "] MTableImplRetrieveNext returning true (pos %d)\n",i);
       *pos = i;
       return true;
     }
-    i = (i + 1) % table->size;
+    i = (i + 1) & mask;
   }
   if( DEBUG2 )
     fprintf(stderr, "] MTableImplRetrieveNext returning false (pos %d)\n", i);
@@ -692,7 +736,7 @@ void MTableImplDelete(MTABLE_U *table, int pos)
   if( DEBUG2 )
     fprintf(stderr, "[ MTableImplDelete(%p, %d \"%s\")\n", (void *) table,
       pos, table->keys[pos]);
-  if( table->keys[(pos + 1) % table->size] == 0x0 )
+  if( table->keys[(pos + 1) & (table->size - 1)] == 0x0 )
   {
     /* safe to set this entry to NULL, since nothing follows */
     table->keys[pos] = 0x0;
@@ -242,6 +242,7 @@ typedef struct {
   int pos;			/* temporary return value (insert and delete)*/
   int value_size;		/* size of values                            */
   char **keys;			/* extensible array of keys                  */
+  int *hashes;			/* hash codes of keys, parallel to keys      */
 } MTABLE_U;
 
 /* the MTABLE macro; these struct fields should not be referred to directly */
@@ -251,12 +252,14 @@ typedef struct {
     TYPE *values;		/* parallel typed array of values   */	\
   }
 
-#define MTableFree(table) (free((table).mtu.keys), free((table).values))
+#define MTableFree(table)						\
+  (free((table).mtu.keys), free((table).mtu.hashes), free((table).values))
 
 #define MTableInit(table)						\
 ( (table).mtu.size = 0, (table).mtu.trigger = 0, (table).mtu.pos = 0,	\
   (table).mtu.value_size = sizeof((table).values[0]),			\
-  (table).mtu.keys = NULL, (table).values = NULL,			\
+  (table).mtu.keys = NULL, (table).mtu.hashes = NULL,			\
+  (table).values = NULL,						\
   (table).values = MTableImplCheckRehash(&(table).mtu,			\
     (char *) (table).values)						\
 )
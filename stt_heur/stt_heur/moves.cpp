@@ -32,6 +32,8 @@ void MoveSwap::configure(int size) {
     }
     
     this->total = this->n = 0;    
+    this->sizeFirst = size;
+    this->sizeSecond = size;
     this->moves = (pair< int, int> *) malloc(sizeof(pair< int, int >) * size * size);
     
     for (int i = 0; i < size; i++) {
@@ -119,3 +121,66 @@ pair< int, int > MoveRealloc::getMove() {
     return r;
 }
 
+
+// ------------------------------------------------------------
+
+MoveTargets::MoveTargets() {
+    this->total = this->n = 0;
+}
+
+void MoveTargets::configure(int size) {
+    this->sources.clear();
+    this->positions.clear();
+    this->targets.clear();
+    this->domains.clear();
+    this->durations.clear();
+    this->total = this->n = 0;
+    this->resize(size);
+}
+
+// novos elementos entram sem destinos e sem dominio: ficam desatualizados
+void MoveTargets::resize(int size) {
+    for (int a = size; a < this->targets.size(); a++)
+        this->setTargets(a, NULL, 0, vector< int >());
+
+    this->positions.resize(size, -1);
+    this->targets.resize(size);
+    this->domains.resize(size, NULL);
+    this->durations.resize(size, -1);
+    this->sizeFirst = size;
+}
+
+void MoveTargets::restart() {
+    // a amostragem e com reposicao: nada a restaurar
+}
+
+bool MoveTargets::isCurrent(int a, const void *domain, int duration) {
+    return this->domains[a] == domain && this->durations[a] == duration;
+}
+
+void MoveTargets::setTargets(int a, const void *domain, int duration, const vector< int > &t) {
+    this->targets[a] = t;
+    this->domains[a] = domain;
+    this->durations[a] = duration;
+
+    // so elementos com algum destino legal podem ser sorteados
+    if (!t.empty() && this->positions[a] == -1) {
+        this->positions[a] = this->sources.size();
+        this->sources.push_back(a);
+    } else if (t.empty() && this->positions[a] != -1) {
+        int last = this->sources.back();
+        this->sources[this->positions[a]] = last;
+        this->positions[last] = this->positions[a];
+        this->sources.pop_back();
+        this->positions[a] = -1;
+    }
+    this->total = this->n = this->sources.size();
+}
+
+int MoveTargets::getSource() {
+    return this->sources[rand() % this->sources.size()];
+}
+
+int MoveTargets::getTarget(int a) {
+    return this->targets[a][rand() % this->targets[a].size()];
+}
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <utility>
 #include <string>
+#include <vector>
 
 #define MAX_NEIGHBORHOOD_SIZE 10000000
 
@@ -38,5 +39,25 @@ public:
     pair< int, int > getMove();
 };
 
+// Realocacao restrita aos destinos legais de cada elemento (ex.: horarios
+// do dominio de um meet). Cada entrada guarda o dominio e a duracao com que
+// foi calculada, e so e refeita quando eles mudam.
+class MoveTargets : public Move {
+public:
+    vector< int > sources;
+    vector< int > positions;
+    vector< vector< int > > targets;
+    vector< const void * > domains;
+    vector< int > durations;
+
+    MoveTargets();
+    void configure(int size);
+    void resize(int size);
+    void restart();
+    bool isCurrent(int a, const void *domain, int duration);
+    void setTargets(int a, const void *domain, int duration, const vector< int > &t);
+    int getSource();
+    int getTarget(int a);
+};
 
 #endif
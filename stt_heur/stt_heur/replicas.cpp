@@ -0,0 +1,171 @@
+#include <iostream>
+#include <cstdlib>
+#include "replicas.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+
+ReplicaPool::ReplicaPool() {
+    this->job = NULL;
+    this->generation = 0;
+    this->running = 0;
+    this->finished = false;
+    this->stale = false;
+}
+
+ReplicaPool::~ReplicaPool() {
+    this->clear();
+}
+
+void ReplicaPool::configure(KHE_SOLN soln, int size) {
+    this->clear();
+
+    // as copias sao feitas aqui, na thread principal
+    for (int i = 0; i < size; i++)
+        this->replicas.push_back(KheSolnCopy(soln));
+    this->stale = false;
+
+    this->finished = false;
+    for (int i = 0; i < size; i++)
+        this->workers.push_back(thread(&ReplicaPool::workerLoop, this, i, this->generation));
+}
+
+void ReplicaPool::clear() {
+    {
+        lock_guard< mutex > guard(this->lock);
+        this->finished = true;
+    }
+    this->start.notify_all();
+    for (int i = 0; i < this->workers.size(); i++)
+        this->workers[i].join();
+    this->workers.clear();
+
+    for (int i = 0; i < this->replicas.size(); i++)
+        KheSolnDelete(this->replicas[i]);
+    this->replicas.clear();
+}
+
+void ReplicaPool::sync(KHE_SOLN soln) {
+    for (int i = 0; i < this->replicas.size(); i++) {
+        KheSolnDelete(this->replicas[i]);
+        this->replicas[i] = KheSolnCopy(soln);
+    }
+    this->stale = false;
+}
+
+// Refaz na copia so as atribuicoes que diferem da solucao. As copias que
+// nao ficarem identicas (ex.: meets divididos) sao copiadas de novo, mas
+// KheSolnCopy nao pode ser chamada com uma transacao aberta na solucao: nesse
+// caso elas ficam para o refresh e o retorno e falso, e quem chamou avalia os
+// movimentos na propria solucao. Verdadeiro se todas as copias estao iguais.
+bool ReplicaPool::align(KHE_SOLN soln) {
+    uint64_t hash = KheSolnAssignHash(soln);
+    this->run([&](int id, KHE_SOLN replica) {
+        if (KheSolnAssignHash(replica) == hash) return;
+        if (KheSolnMeetCount(replica) != KheSolnMeetCount(soln) ||
+                KheSolnTaskCount(replica) != KheSolnTaskCount(soln)) return;
+
+        // duas passadas: uma atribuicao pode depender de outra ainda nao refeita
+        for (int pass = 0; pass < 2 && KheSolnAssignHash(replica) != hash; pass++) {
+            for (int i = 0; i < KheSolnMeetCount(soln); i++) {
+                KHE_MEET meet = KheSolnMeet(soln, i), copy = KheSolnMeet(replica, i);
+                KHE_MEET target = KheMeetAsst(meet);
+                KHE_MEET copyTarget = target == NULL ? NULL : KheSolnMeet(replica, KheMeetIndex(target));
+                if (KheMeetAsst(copy) != copyTarget || KheMeetAsstOffset(copy) != KheMeetAsstOffset(meet))
+                    KheMeetMove(copy, copyTarget, KheMeetAsstOffset(meet));
+            }
+            for (int i = 0; i < KheSolnTaskCount(soln); i++) {
+                KHE_TASK task = KheSolnTask(soln, i), copy = KheSolnTask(replica, i);
+                KHE_TASK target = KheTaskAsst(task);
+                KHE_TASK copyTarget = target == NULL ? NULL : KheSolnTask(replica, KheTaskIndexInSoln(target));
+                if (KheTaskAsst(copy) != copyTarget)
+                    KheTaskMove(copy, copyTarget);
+            }
+        }
+    });
+
+    // KheSolnCopy altera campos da solucao de origem: fica na thread principal
+    bool aligned = true;
+    for (int i = 0; i < this->replicas.size(); i++) {
+        if (KheSolnAssignHash(this->replicas[i]) == hash) continue;
+        if (KheSolnTransactionOpen(soln)) {
+            this->stale = true;
+            aligned = false;
+        } else {
+            KheSolnDelete(this->replicas[i]);
+            this->replicas[i] = KheSolnCopy(soln);
+        }
+    }
+    return aligned;
+}
+
+// Copia de novo as copias que o align nao pode refazer; so age fora de
+// transacoes e, sem copias pendentes, nao custa nada (pode ir em todo laco)
+void ReplicaPool::refresh(KHE_SOLN soln) {
+    if (!this->stale || KheSolnTransactionOpen(soln)) return;
+    uint64_t hash = KheSolnAssignHash(soln);
+    for (int i = 0; i < this->replicas.size(); i++) {
+        if (KheSolnAssignHash(this->replicas[i]) != hash ||
+                KheSolnMeetCount(this->replicas[i]) != KheSolnMeetCount(soln)) {
+            KheSolnDelete(this->replicas[i]);
+            this->replicas[i] = KheSolnCopy(soln);
+        }
+    }
+    this->stale = false;
+}
+
+// Reaplica nas copias o log de uma transacao da solucao (ver
+// KheTransactionLogExport). So recebem o log as copias que estavam iguais a
+// solucao antes da transacao (hash from); as demais ficam para o align.
+void ReplicaPool::replay(KHE_SOLN soln, uint64_t from, vector< int > &log) {
+    if (!log.empty()) {
+        this->run([&](int id, KHE_SOLN replica) {
+            if (KheSolnAssignHash(replica) == from)
+                KheSolnReplayLog(replica, log.data(), log.size());
+        });
+    }
+    this->align(soln);
+}
+
+int ReplicaPool::size() {
+    return this->replicas.size();
+}
+
+KHE_SOLN ReplicaPool::replica(int i) {
+    return this->replicas[i];
+}
+
+void ReplicaPool::run(const function< void(int, KHE_SOLN) > &job) {
+    unique_lock< mutex > guard(this->lock);
+    this->job = &job;
+    this->running = this->workers.size();
+    this->generation++;
+    this->start.notify_all();
+
+    while (this->running > 0)
+        this->done.wait(guard);
+    this->job = NULL;
+}
+
+void ReplicaPool::workerLoop(int id, int seen) {
+    while (true) {
+        const function< void(int, KHE_SOLN) > *current;
+        {
+            unique_lock< mutex > guard(this->lock);
+            while (this->generation == seen && !this->finished)
+                this->start.wait(guard);
+            if (this->finished) return;
+            seen = this->generation;
+            current = this->job;
+        }
+
+        (*current)(id, this->replicas[id]);
+
+        {
+            lock_guard< mutex > guard(this->lock);
+            this->running--;
+        }
+        this->done.notify_one();
+    }
+}
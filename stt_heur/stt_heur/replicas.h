@@ -0,0 +1,52 @@
+#ifndef replicas_h
+#define replicas_h
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+using namespace std;
+
+// Copias de uma solucao, cada uma atendida por uma thread propria.
+// Servem para avaliar movimentos em paralelo: cada thread so altera a sua
+// copia, e os movimentos aceitos sao reaplicados em todas as copias.
+class ReplicaPool {
+public:
+    ReplicaPool();
+    ~ReplicaPool();
+
+    void configure(KHE_SOLN soln, int size);
+    void clear();
+    void sync(KHE_SOLN soln);
+    bool align(KHE_SOLN soln);
+    void refresh(KHE_SOLN soln);
+    void replay(KHE_SOLN soln, uint64_t from, vector< int > &log);
+
+    int size();
+    KHE_SOLN replica(int i);
+
+    // executa job(id, copia) em todas as copias e espera todas terminarem
+    void run(const function< void(int, KHE_SOLN) > &job);
+
+private:
+    vector< KHE_SOLN > replicas;
+    vector< thread > workers;
+
+    mutex lock;
+    condition_variable start, done;
+    const function< void(int, KHE_SOLN) > *job;
+    int generation;
+    int running;
+    bool finished;
+    bool stale;     // alguma copia ficou diferente da solucao (ver align)
+
+    void workerLoop(int id, int seen);
+};
+
+#endif
@@ -0,0 +1,289 @@
+#include <iostream>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+extern "C" {
+#include "khe/khe.h"
+#include "khe/khe_interns.h"
+};
+
+#include "solver.h"
+#include "heuristics.h"
+#include "telemetry.h"
+#include "bounds.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+
+// Le o arquivo; com exitOnError falso, um erro de leitura devolve NULL em
+// vez de encerrar o programa
+KHE_ARCHIVE ReadArchive(const char *fname, bool exitOnError) {
+    FILE *fp;  KHE_ARCHIVE res;  KML_ERROR ke;
+    fp = fopen(fname, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "khe: cannot open file \"%s\" for reading\n", fname);
+        if (!exitOnError) return NULL;
+        exit( EXIT_FAILURE );
+    }
+    if (!KheArchiveRead(fp, &res, true, &ke)) {
+        fprintf(stderr, "%s:%d:%d: %s\n", fname, KmlErrorLineNum(ke), KmlErrorColNum(ke), KmlErrorString(ke));
+        fclose(fp);
+        if (!exitOnError) return NULL;
+        exit( EXIT_FAILURE );
+    }
+    fclose(fp);
+    return res;
+}
+
+// Solucao de partida: a solucao inicial do arquivo da instancia ou, com -sol,
+// a de menor custo para a instancia no arquivo de solucoes (os grupos lidos
+// ficam no arquivo em memoria). O estado da busca gravado junto dela, se houver,
+// vai para config.state.
+KHE_SOLN StartSoln(KHE_SOLN initial, KHE_ARCHIVE archive, KHE_INSTANCE instance, Config &config) {
+    if (config.sol == NULL) return initial;
+    
+    FILE *fp = fopen(config.sol, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "khe: cannot open file \"%s\" for reading\n", config.sol);
+        exit( EXIT_FAILURE );
+    }
+    KML_ERROR ke;
+    int first = KheArchiveSolnGroupCount(archive);
+    if (!KheArchiveReadSolnGroups(archive, fp, &ke)) {
+        fprintf(stderr, "%s:%d:%d: %s\n", config.sol, KmlErrorLineNum(ke), KmlErrorColNum(ke), KmlErrorString(ke));
+        exit( EXIT_FAILURE );
+    }
+    fclose(fp);
+    
+    // os grupos ja lidos com a instancia sao pulados pela KHE: se o arquivo
+    // so tinha esses, a busca vai sobre todos os grupos do arquivo
+    KHE_SOLN best = NULL;
+    if (first == KheArchiveSolnGroupCount(archive))
+        first = 0;
+    for (int i = first; i < KheArchiveSolnGroupCount(archive); i++) {
+        KHE_SOLN_GROUP solg = KheArchiveSolnGroup(archive, i);
+        for (int j = 0; j < KheSolnGroupSolnCount(solg); j++) {
+            KHE_SOLN soln = KheSolnGroupSoln(solg, j);
+            if (KheSolnInstance(soln) == instance && (best == NULL || KheSolnCost(soln) < KheSolnCost(best)))
+                best = soln;
+        }
+    }
+    if (best == NULL) {
+        cerr << "No solution for instance " << KheInstanceId(instance) << " in " << config.sol << endl;
+        exit(EXIT_FAILURE);
+    }
+    
+    char fname[1024];
+    snprintf(fname, sizeof(fname), "%s.state", config.sol);
+    if (ReadSearchState(config.state, fname))
+        printf("Resuming search state from %s\n", fname);
+    KHE_COST cost = KheSolnCost(best);
+    printf("Warm start from %s: %d , %d\n", config.sol, KheHardCost(cost), KheSoftCost(cost));
+    return best;
+}
+
+// Estado da busca em linhas chave=valor; as chaves desconhecidas sao
+// ignoradas. Falso se o arquivo nao existe.
+bool ReadSearchState(SearchState &state, const char *fname) {
+    FILE *fp = fopen(fname, "r");
+    if (fp == NULL) return false;
+    char line[256];
+    double dvalue;
+    int value;
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        if (sscanf(line, "sa_temp=%lf", &dvalue) == 1)
+            state.saTemp = dvalue;
+        else if (sscanf(line, "sa_reheats=%d", &value) == 1)
+            state.saReheats = value;
+        else if (sscanf(line, "ils_perturbation=%d", &value) == 1)
+            state.ilsPerturbation = value;
+    }
+    fclose(fp);
+    return true;
+}
+
+// Grava o estado da busca em <fname>.state, ao lado da solucao
+void WriteSearchState(SearchState &state, const char *fname) {
+    char stateName[1024];
+    snprintf(stateName, sizeof(stateName), "%s.state", fname);
+    FILE *fp = fopen(stateName, "w");
+    if (fp == NULL) {
+        fprintf(stderr, "khe: cannot open file \"%s\" for writing\n", stateName);
+        return;
+    }
+    fprintf(fp, "sa_temp=%.17g\n", state.saTemp);
+    fprintf(fp, "sa_reheats=%d\n", state.saReheats);
+    fprintf(fp, "ils_perturbation=%d\n", state.ilsPerturbation);
+    fclose(fp);
+}
+
+// Grupo de solucoes com os dados da equipe, um por execucao (a semente vai
+// nas observacoes)
+KHE_SOLN_GROUP MakeSolnGroup(KHE_ARCHIVE archive, Config &config) {
+    //___________________________________________________________________________
+    /************************ Get current time/date ****************************/
+    time_t rawtime;
+    struct tm * timeinfo;
+    time(&rawtime);
+    timeinfo = localtime(&rawtime);
+    char* timeDesctiption = asctime(timeinfo);
+    char team[100];
+    char remarks[100];
+    char title[100];
+    
+    sprintf(team, "GOAL team: Fonseca, G.H.G., Brito, S., Toffolo, T. and Santos, H.G.");
+    sprintf(remarks, "Under development (Random seed = %d)", config.seed);
+    sprintf(title, "Hibrid heuristic and IP methods");
+    
+    // a KHE guarda os ponteiros sem copiar: as strings precisam durar ate a
+    // escrita da solucao (e asctime reusa o seu buffer)
+    KHE_SOLN_GROUP_METADATA md = KheSolnGroupMetaDataMake(
+        strdup(team),
+        strdup(timeDesctiption),
+        strdup(title),
+        strdup(remarks)
+    );
+    KHE_SOLN_GROUP solg;
+    char solnGroupId[256];
+    sprintf(solnGroupId, "GOAL team %.24s (seed %d)", timeDesctiption, config.seed);
+    if (!KheSolnGroupMake(archive, strdup(solnGroupId), md, &solg)) {
+        fprintf(stderr, "error.\n");
+        exit(1);
+    }
+    return solg;
+}
+
+// Remove do arquivo um grupo feito por MakeSolnGroup, com as suas strings
+void DeleteSolnGroup(KHE_SOLN_GROUP solg) {
+    KHE_SOLN_GROUP_METADATA md = KheSolnGroupMetaData(solg);
+    char *strings[] = {
+        KheSolnGroupId(solg),
+        KheSolnGroupMetaDataContributor(md),
+        KheSolnGroupMetaDataDate(md),
+        KheSolnGroupMetaDataDescription(md),
+        KheSolnGroupMetaDataRemarks(md)
+    };
+    KheSolnGroupDelete(solg);
+    for (int i = 0; i < 5; i++)
+        free(strings[i]);
+}
+
+// Executa a busca a partir de soln, que passa a ser da busca, e devolve a
+// melhor solucao encontrada
+KHE_SOLN Solve(KHE_SOLN soln, KHE_INSTANCE instance, Config &config) {
+    //___________________________________________________________________________
+    //*************************** Run first heuristic ***************************
+    KHE_COST cost = KheSolnCost(soln);
+    printf("Initial solution: %d , %d\n", KheHardCost(cost), KheSoftCost(cost));
+    fflush(stdout);
+    
+    if (config.lns)
+        lnsPrepare(soln);
+    configureMoves(soln, instance, config);
+    bounds.start(soln, instance, config);
+    if (bounds.reached(soln))
+        printf("Initial solution reaches the lower bound\n");
+    if (config.telemetry)
+        telemetry.start(config.telemetry, config.telemetryInterval);
+    
+    printf("Elapsed time: %d of %d\n", config.getRunTime(), config.timeLimit);
+    
+//    for(int i = 0; i < KheSolnDefectCount(soln); ++i) {
+//        for(int j = 0; j < KheMonitorDeviationCount(KheSolnDefect(soln, i)); ++j) {
+//            printf("%s\n", KheMonitorDeviationDescription(KheSolnDefect(soln, i), j));
+//        }
+//    }
+
+//    printf("%d\n", KheSolnDefectCount(soln));
+//    printf("%d\n", KheGroupMonitorDefectCount((KHE_GROUP_MONITOR) soln));
+//    for(int i = 0; i < KheSolnDefectCount(soln); ++i) {
+//        if(strcmp(KheMonitorTagShow(KheMonitorTag(KheSolnDefect(soln, i))), "KHE_AVOID_CLASHES_MONITOR_TAG") == 0)
+//            printf("XXXXX %s %s\n", KheMonitorTagShow(KheMonitorTag(KheSolnDefect(soln, i))), KheMonitorAppliesToName(KheSolnDefect(soln, i)));
+//    }
+    if (config.tabu) {
+        printf("\nStarting Tabu Search\n");
+        soln = tabuSearch(soln, instance, config);
+    } else if (config.lns) {
+        printf("\nStarting Large Neighbourhood Search (LNS)\n");
+        soln = lns(soln, instance, config);
+    } else {
+        printf("\nStarting Simulated Annealing\n");
+        soln = simulatedAnnealing(soln, instance, config);
+    
+        printf("\nStarting Iterated Local Search (ILS)\n");
+        soln = ils(soln, instance, config);
+    }
+    
+//    printf("\nStarting Variable Neighborhood Search (VNS)\n");
+//    soln = vns(soln, instance, config);
+    //soln = rvns(soln, instance, config);
+    
+    //__________________________________________________________________________
+    //*********************** Run Iterated Local Search ************************
+    //___________________________________________________________________________
+    /*************************** Evaluate solution *****************************/
+    telemetry.stop();
+    bounds.stop();
+    releaseMoves();
+    KheSolnEnsureOfficialCost(soln);
+    cost = KheSolnCost(soln);
+    fflush(stdout);
+    printf("Hard cost: %d\nSoft cost: %d\nElapesed time: %ds\n",
+           KheHardCost(cost), KheSoftCost(cost), config.getRunTime());
+    return soln;
+}
+
+void WriteSoln(KHE_SOLN_GROUP solg, KHE_SOLN soln, const char *fname) {
+    //___________________________________________________________________________
+    /***************************** Write solution ******************************/
+    //if (soln)
+    //KheSolnDelete(soln);
+    //KheSolnSetSolnGroup(optimumSoln, solg);
+    //FILE *fsol = fopen(argv[1], "w");
+    //KheArchiveWrite(archive, true, fsol);
+    
+    KheSolnGroupAddSoln(solg, soln);
+    //FILE *fsol = fopen((string(config.outPrefix) + ".sol").c_str(), "w");
+    FILE *fsol = fopen(fname, "w");
+    if (fsol == NULL) {
+        fprintf(stderr, "khe: cannot open file \"%s\" for writing\n", fname);
+        exit( EXIT_FAILURE );
+    }
+    KheSolnGroupWrite(solg, true, KmlMakeFile(fsol, 2, 2));
+    fclose(fsol);
+}
+
+// Le uma instancia e devolve a solucao inicial que vem no arquivo (NULL
+// se o arquivo nao serve e exitOnError e falso)
+KHE_SOLN ReadInstance(const char *fname, KHE_ARCHIVE &archive, KHE_INSTANCE &instance, bool exitOnError) {
+    //___________________________________________________________________________
+    /******************************* File read *********************************/
+    archive = ReadArchive(fname, exitOnError);
+    if (archive == NULL) return NULL;
+    if (KheArchiveInstanceCount(archive) > 1) {
+        cerr << "Please enter a XML with only one instance." << endl;
+        if (!exitOnError) return NULL;
+        exit(EXIT_FAILURE);
+    }
+    if (KheArchiveInstanceCount(archive) == 0 || KheArchiveSolnGroupCount(archive) == 0) {
+        cerr << "Please enter a XML with an instance and an initial solution." << endl;
+        if (!exitOnError) return NULL;
+        exit(EXIT_FAILURE);
+    }
+    
+    //___________________________________________________________________________
+    /*********************** Get elements of instances *************************/
+    instance = KheArchiveInstance(archive, 0);
+    printf("instance name is %s\n", KheInstanceName(instance));
+    
+    //soln = KheGeneralSolve(soln);
+    //soln = KheParallelSolve(soln, THREADS, &KheGeneralSolve);
+    return KheSolnGroupSoln(KheArchiveSolnGroup(archive, 0), 0);
+//    for(int i = 0; i < KheSolnMeetCount(soln); ++i) {
+//        if(KheMeetEvent(KheSolnMeet(soln, i)) != NULL)
+//            printf("%s %d\n", KheEventId(KheMeetEvent(KheSolnMeet(soln, i))), KheMeetDuration(KheSolnMeet(soln, i)));
+//    }
+}
@@ -0,0 +1,22 @@
+#ifndef solver_h
+#define solver_h
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+#include "config.h"
+
+// Leitura da instancia, execucao da busca e escrita da solucao, comuns a
+// execucao simples, ao modo em lote e aos jobs do daemon
+KHE_ARCHIVE ReadArchive(const char *fname, bool exitOnError);
+KHE_SOLN ReadInstance(const char *fname, KHE_ARCHIVE &archive, KHE_INSTANCE &instance, bool exitOnError);
+KHE_SOLN StartSoln(KHE_SOLN initial, KHE_ARCHIVE archive, KHE_INSTANCE instance, Config &config);
+KHE_SOLN_GROUP MakeSolnGroup(KHE_ARCHIVE archive, Config &config);
+void DeleteSolnGroup(KHE_SOLN_GROUP solg);
+KHE_SOLN Solve(KHE_SOLN soln, KHE_INSTANCE instance, Config &config);
+void WriteSoln(KHE_SOLN_GROUP solg, KHE_SOLN soln, const char *fname);
+bool ReadSearchState(SearchState &state, const char *fname);
+void WriteSearchState(SearchState &state, const char *fname);
+
+#endif
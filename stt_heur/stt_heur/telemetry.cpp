@@ -0,0 +1,131 @@
+#include <iostream>
+#include <cstdlib>
+#include "telemetry.h"
+
+using namespace std;
+
+Telemetry telemetry;
+
+//--------------------------------------------------------------------------
+
+// monitores sem custo proprio ficam fora do log
+static bool isReportedTag(int tag) {
+    return tag != KHE_TIMETABLE_MONITOR_TAG && tag != KHE_TIME_GROUP_MONITOR_TAG &&
+            tag != KHE_GROUP_MONITOR_TAG;
+}
+
+Telemetry::Telemetry() {
+    this->enabled = false;
+    this->finished = false;
+    this->file = NULL;
+    this->iters = this->accepted = 0;
+    this->lastIters = this->lastAccepted = 0;
+}
+
+Telemetry::~Telemetry() {
+    this->stop();
+}
+
+void Telemetry::start(const char *fileName, int intervalMs) {
+    this->file = fopen(fileName, "w");
+    if (this->file == NULL) {
+        cerr << "ERROR: cannot open telemetry file " << fileName << endl;
+        return;
+    }
+
+    this->interval = chrono::milliseconds(intervalMs);
+    this->timeIni = this->lastSample = chrono::steady_clock::now();
+    this->iters = this->accepted = 0;
+    this->lastIters = this->lastAccepted = 0;
+    this->finished = false;
+    this->writeHeader();
+
+    this->writer = thread(&Telemetry::writerLoop, this);
+    this->enabled = true;
+}
+
+void Telemetry::stop() {
+    if (!this->enabled) return;
+    this->enabled = false;
+
+    {
+        lock_guard< mutex > guard(this->lock);
+        this->finished = true;
+    }
+    this->ready.notify_one();
+    this->writer.join();
+
+    fclose(this->file);
+    this->file = NULL;
+}
+
+void Telemetry::checkSample(KHE_SOLN soln, int neighborhood) {
+    chrono::steady_clock::time_point now = chrono::steady_clock::now();
+    if (now - this->lastSample < this->interval) return;
+
+    // a leitura da solucao precisa ser feita nesta thread
+    TelemetrySample sample;
+    double elapsed = chrono::duration< double >(now - this->lastSample).count();
+    long iterDelta = this->iters - this->lastIters;
+    sample.timeMs = (long) chrono::duration_cast< chrono::milliseconds >(now - this->timeIni).count();
+    sample.iter = this->iters;
+    sample.itersPerSec = iterDelta / elapsed;
+    sample.acceptRate = iterDelta > 0 ? (double) (this->accepted - this->lastAccepted) / iterDelta : 0.0;
+    sample.neighborhood = neighborhood;
+    sample.cost = KheSolnCost(soln);
+
+    int defects;
+    for (int tag = 0; tag < KHE_MONITOR_TAG_COUNT; tag++)
+        sample.costByType[tag] = isReportedTag(tag) ? KheSolnCostByType(soln, (KHE_MONITOR_TAG) tag, &defects) : 0;
+
+    this->lastSample = now;
+    this->lastIters = this->iters;
+    this->lastAccepted = this->accepted;
+
+    {
+        lock_guard< mutex > guard(this->lock);
+        this->pending.push_back(sample);
+    }
+    this->ready.notify_one();
+}
+
+void Telemetry::writeHeader() {
+    fprintf(this->file, "time_ms,iter,iters_per_sec,accept_rate,neighborhood,hard,soft");
+    for (int tag = 0; tag < KHE_MONITOR_TAG_COUNT; tag++) {
+        if (!isReportedTag(tag)) continue;
+        const char *name = KheMonitorTagShow((KHE_MONITOR_TAG) tag);
+        fprintf(this->file, ",%s_hard,%s_soft", name, name);
+    }
+    fprintf(this->file, "\n");
+}
+
+void Telemetry::writeSample(const TelemetrySample &sample) {
+    fprintf(this->file, "%ld,%ld,%.0lf,%.4lf,%d,%d,%d", sample.timeMs, sample.iter,
+            sample.itersPerSec, sample.acceptRate, sample.neighborhood,
+            KheHardCost(sample.cost), KheSoftCost(sample.cost));
+    for (int tag = 0; tag < KHE_MONITOR_TAG_COUNT; tag++) {
+        if (!isReportedTag(tag)) continue;
+        fprintf(this->file, ",%d,%d", KheHardCost(sample.costByType[tag]), KheSoftCost(sample.costByType[tag]));
+    }
+    fprintf(this->file, "\n");
+}
+
+void Telemetry::writerLoop() {
+    vector< TelemetrySample > batch;
+    bool done = false;
+
+    while (!done) {
+        {
+            unique_lock< mutex > guard(this->lock);
+            while (this->pending.empty() && !this->finished)
+                this->ready.wait(guard);
+            batch.assign(this->pending.begin(), this->pending.end());
+            this->pending.clear();
+            done = this->finished;
+        }
+
+        for (int i = 0; i < batch.size(); i++)
+            this->writeSample(batch[i]);
+        fflush(this->file);
+    }
+}
@@ -0,0 +1,71 @@
+#ifndef telemetry_h
+#define telemetry_h
+
+#include <cstdio>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+extern "C" {
+#include "khe/khe.h"
+}
+
+using namespace std;
+
+// Amostra do estado da busca em um instante
+class TelemetrySample {
+public:
+    long timeMs;
+    long iter;
+    double itersPerSec;
+    double acceptRate;
+    int neighborhood;
+    KHE_COST cost;
+    KHE_COST costByType[KHE_MONITOR_TAG_COUNT];
+};
+
+// Amostragem periodica do custo por tipo de monitor, gravada em CSV
+// por uma thread separada para nao atrasar o laco principal
+class Telemetry {
+public:
+    Telemetry();
+    ~Telemetry();
+
+    void start(const char *fileName, int intervalMs);
+    void stop();
+
+    inline void iteration(KHE_SOLN soln, int neighborhood, bool accepted) {
+        if (!this->enabled) return;
+        this->iters++;
+        if (accepted) this->accepted++;
+        // o relogio e consultado a cada iteracao: buscas por rodadas (descida
+        // pelo melhor, tabu, LNS) fazem poucas iteracoes por segundo
+        this->checkSample(soln, neighborhood);
+    }
+
+private:
+    bool enabled;
+    bool finished;
+    FILE *file;
+    chrono::milliseconds interval;
+    chrono::steady_clock::time_point timeIni, lastSample;
+    long iters, accepted;
+    long lastIters, lastAccepted;
+
+    deque< TelemetrySample > pending;
+    mutex lock;
+    condition_variable ready;
+    thread writer;
+
+    void checkSample(KHE_SOLN soln, int neighborhood);
+    void writeHeader();
+    void writeSample(const TelemetrySample &sample);
+    void writerLoop();
+};
+
+extern Telemetry telemetry;
+
+#endif